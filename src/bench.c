@@ -0,0 +1,331 @@
+/* Benchmark for the sudoku library: times sudoku_solve_with_p,
+sudoku_is_correct_p and sudoku_generate_with_p */
+
+/* for clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sudoku.h"
+
+/* default number of repetitions of each measurement */
+#define BENCH_REPS 20
+
+/* number of puzzles of each generated set */
+#define BENCH_SET_SIZE 100
+
+/* seed of the generated sets and of the solvers, so that every run does
+the same work */
+#define BENCH_SEED 1
+
+/* Struct that holds the measurements of a benchmark.
+
+Fields:
+> times: the time of each run, in seconds.
+
+> runs: the number of runs.
+
+> nodes: the search nodes of all runs (see Solver_T).
+*/
+typedef struct bench_s {
+    double *times;
+    int runs;
+    unsigned long nodes;
+} Bench_T;
+
+double bench_now(void);
+void bench_init(Bench_T *bench, int max);
+int bench_compare(const void *a, const void *b);
+void bench_report(Bench_T *bench, const char *kind, const char *engine,
+                  const char *input);
+void bench_solve(const char *input, const Grid_T *grids, int n, int reps);
+void bench_correct(const char *input, const Grid_T *grids, int n, int reps);
+void bench_generate(int nelts, int reps);
+
+/* engines that are measured by bench_solve, and their names */
+static const int bench_engines[] = {
+    SUDOKU_ENGINE_BACKTRACK, SUDOKU_ENGINE_ITERATIVE, SUDOKU_ENGINE_DLX
+};
+static const char *bench_engine_names[] = {
+    "backtrack", "iterative", "dlx"
+};
+
+/* main
+
+Runs the benchmarks and writes one line per benchmark to stdout. The
+fields of a line are separated by tabs, and the first line has their names:
+
+kind: solve, is_correct or generate.
+engine: the solver engine, or - for is_correct.
+input: the puzzle file, or the set of generated puzzles.
+runs: the number of timed calls.
+min_us, median_us, p99_us: the time of a call, in microseconds.
+per_sec: calls per second, from the total time of the runs.
+nodes: the mean number of search nodes of a call.
+
+Use:
+
+1) Measure the puzzles of the given files and the generated sets:
+./sudoku-bench puzzle_file_1 puzzle_file_2
+
+2) Same as 1) with 100 repetitions of each measurement:
+./sudoku-bench -r 100 puzzle_file_1 puzzle_file_2
+
+3) Measure the puzzles folder (make bench):
+make bench
+
+The generated sets have BENCH_SET_SIZE puzzles with 25 and 35 non-zero
+cells. Every file must hold one puzzle in a format of sudoku_read_file. */
+int main(int argc, char **argv) {
+    int i, n, reps, ret, nelts;
+    Grid_T *grids;
+    Solver_T solver;
+    FILE *fp;
+    char input[32];
+    static const int sets[] = {25, 35};
+
+    reps = BENCH_REPS;
+    i = 1;
+    if (argc > 2 && !strcmp(argv[1], "-r")) {
+        reps = atoi(argv[2]);
+        i = 3;
+    }
+    if (reps < 1) {
+        fprintf(stderr, "Usage: %s [-r <reps>] [file...]\n", argv[0]);
+        return 1;
+    }
+
+    grids = malloc(BENCH_SET_SIZE * sizeof(Grid_T));
+    if (!grids) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    printf("kind\tengine\tinput\truns\tmin_us\tmedian_us\tp99_us\tper_sec");
+    printf("\tnodes\n");
+
+    /* the puzzles of the given files */
+    for (; i < argc; i++) {
+        fp = fopen(argv[i], "r");
+        if (!fp) {
+            fprintf(stderr, "Cannot open %s\n", argv[i]);
+            continue;
+        }
+        ret = sudoku_read_file(fp, &grids[0]);
+        fclose(fp);
+        if (ret != 1) {
+            fprintf(stderr, "Puzzle of %s has incorrect format\n", argv[i]);
+            continue;
+        }
+        bench_solve(argv[i], grids, 1, reps);
+        sudoku_solve_p(&grids[0], &grids[0]);
+        bench_correct(argv[i], grids, 1, reps);
+    }
+
+    /* sets of generated puzzles */
+    for (i = 0; i < (int)(sizeof(sets) / sizeof(sets[0])); i++) {
+        nelts = sets[i];
+        sudoku_solver_init(&solver);
+        sudoku_solver_seed(&solver, BENCH_SEED);
+        solver.threads = 1;
+        sudoku_generate_batch(&solver, nelts, grids, BENCH_SET_SIZE);
+        sprintf(input, "generated-%d", nelts);
+        bench_solve(input, grids, BENCH_SET_SIZE, reps);
+        for (n = 0; n < BENCH_SET_SIZE; n++) {
+            sudoku_solve_p(&grids[n], &grids[n]);
+        }
+        bench_correct(input, grids, BENCH_SET_SIZE, reps);
+        bench_generate(nelts, reps);
+    }
+    free(grids);
+    return 0;
+}
+
+
+/* bench_now
+
+Reads a clock that is not affected by changes of the system time.
+
+Parameters: void
+
+Returns: the time in seconds since an unspecified point */
+double bench_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* bench_init
+
+Initializes the given benchmark to no runs, with room for max runs. Exits if
+there is not enough memory.
+
+Parameters:
+bench: a pointer to a Bench_T type
+max: the number of runs
+
+Returns: void */
+void bench_init(Bench_T *bench, int max) {
+    bench->times = malloc(max * sizeof(double));
+    if (!bench->times) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    bench->runs = 0;
+    bench->nodes = 0;
+    return;
+}
+
+
+/* bench_compare
+
+Compares two times for qsort.
+
+Parameters:
+a, b: pointers to double types
+
+Returns: a negative, zero or positive value if a is less than, equal to or
+greater than b */
+int bench_compare(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+/* bench_report
+
+Writes the line of the given benchmark to stdout (see main) and frees its
+times.
+
+Parameters:
+bench: a pointer to a Bench_T type
+kind, engine, input: the first fields of the line
+
+Returns: void */
+void bench_report(Bench_T *bench, const char *kind, const char *engine,
+                  const char *input) {
+    int i, p99;
+    double total;
+
+    for (i = 0, total = 0; i < bench->runs; i++) {
+        total += bench->times[i];
+    }
+    qsort(bench->times, bench->runs, sizeof(double), bench_compare);
+
+    /* the smallest time that is not less than 99% of the times */
+    p99 = (bench->runs * 99 + 99) / 100 - 1;
+    printf("%s\t%s\t%s\t%d\t%.3f\t%.3f\t%.3f\t%.1f\t%.1f\n", kind, engine,
+           input, bench->runs, bench->times[0] * 1e6,
+           bench->times[bench->runs / 2] * 1e6, bench->times[p99] * 1e6,
+           total > 0 ? bench->runs / total : 0.0,
+           (double)bench->nodes / bench->runs);
+    fflush(stdout);
+    free(bench->times);
+    return;
+}
+
+
+/* bench_solve
+
+Solves each of the given puzzles reps times with each engine and reports
+one line per engine. The solver of each puzzle is seeded with BENCH_SEED
+plus its index, so every repetition does the same search.
+
+Parameters:
+input: the name of the puzzles
+grids: array of n puzzles
+n: number of puzzles
+reps: number of repetitions
+
+Returns: void */
+void bench_solve(const char *input, const Grid_T *grids, int n, int reps) {
+    int e, r, i;
+    double start;
+    Bench_T bench;
+    Solver_T solver;
+    Grid_T solved;
+
+    for (e = 0; e < (int)(sizeof(bench_engines) / sizeof(int)); e++) {
+        bench_init(&bench, n * reps);
+        sudoku_solver_init(&solver);
+        solver.engine = bench_engines[e];
+        for (r = 0; r < reps; r++) {
+            for (i = 0; i < n; i++) {
+                sudoku_solver_seed(&solver, BENCH_SEED + i);
+                start = bench_now();
+                sudoku_solve_with_p(&solver, &grids[i], &solved);
+                bench.times[bench.runs++] = bench_now() - start;
+            }
+        }
+        bench.nodes = solver.nodes;
+        bench_report(&bench, "solve", bench_engine_names[e], input);
+    }
+    return;
+}
+
+
+/* bench_correct
+
+Checks the correctness of each of the given puzzles reps times with
+sudoku_is_correct_p and reports one line.
+
+Parameters:
+input: the name of the puzzles
+grids: array of n puzzles
+n: number of puzzles
+reps: number of repetitions
+
+Returns: void */
+void bench_correct(const char *input, const Grid_T *grids, int n, int reps) {
+    int r, i;
+    double start;
+    Bench_T bench;
+
+    bench_init(&bench, n * reps);
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < n; i++) {
+            start = bench_now();
+            sudoku_is_correct_p(&grids[i], 1);
+            bench.times[bench.runs++] = bench_now() - start;
+        }
+    }
+    bench_report(&bench, "is_correct", "-", input);
+    return;
+}
+
+
+/* bench_generate
+
+Generates reps puzzles with nelts non-zero cells and reports one line. The
+nodes are those of the solution counts that check uniqueness.
+
+Parameters:
+nelts: number of non-zero cells
+reps: number of repetitions
+
+Returns: void */
+void bench_generate(int nelts, int reps) {
+    int r;
+    double start;
+    Bench_T bench;
+    Solver_T solver;
+    Grid_T grid;
+    char input[32];
+
+    bench_init(&bench, reps);
+    sudoku_solver_init(&solver);
+    sudoku_solver_seed(&solver, BENCH_SEED);
+    for (r = 0; r < reps; r++) {
+        start = bench_now();
+        sudoku_generate_with_p(&solver, nelts, &grid);
+        bench.times[bench.runs++] = bench_now() - start;
+    }
+    bench.nodes = solver.nodes;
+    sprintf(input, "nelts-%d", nelts);
+    bench_report(&bench, "generate", "backtrack", input);
+    return;
+}
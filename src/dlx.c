@@ -0,0 +1,343 @@
+/* Dancing Links interface: Solves a sudoku grid as an exact cover problem */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "dlx.h"
+
+/* root node, column headers and 4 nodes per candidate */
+#define DLX_NODES (1 + DLX_COLUMNS + 4 * DLX_ROWS)
+
+
+/* Struct that represents an exact cover matrix as a set of circular doubly
+linked lists.
+
+Fields:
+> left, right, up, down: the links of each node. Node 0 is the root, nodes 1
+to DLX_COLUMNS are the column headers and the rest are matrix entries.
+
+> col: the column header of each node.
+
+> cand: the candidate of each node, encoded as (row * SIZE + col) * SIZE +
+val - 1.
+
+> size: the number of nodes in each column.
+
+> count: the number of used nodes.
+
+> sol[SIZE*SIZE]: the candidates that have been selected by the search.
+
+> nodes: the counter of the rows that have been tried by the search.
+
+> aborted, data: the function that is called with data before each row is
+tried, NULL to never stop the search.
+
+> stopped: 1 if the search was stopped by aborted.
+*/
+typedef struct dlx_s {
+    int left[DLX_NODES];
+    int right[DLX_NODES];
+    int up[DLX_NODES];
+    int down[DLX_NODES];
+    int col[DLX_NODES];
+    int cand[DLX_NODES];
+    int size[DLX_COLUMNS + 1];
+    int count;
+    int sol[SIZE * SIZE];
+    unsigned long *nodes;
+    int (*aborted)(void *data);
+    void *data;
+    int stopped;
+} Dlx_T;
+
+static void dlx_init(Dlx_T *dlx);
+static void dlx_add_candidate(Dlx_T *dlx, int row, int col, int val);
+static void dlx_cover(Dlx_T *dlx, int c);
+static void dlx_uncover(Dlx_T *dlx, int c);
+static int dlx_search(Dlx_T *dlx, int depth);
+
+
+/* dlx_init
+
+Initializes the matrix to the column headers only.
+
+Checks: if dlx is NULL.
+
+Parameters:
+dlx: pointer to a Dlx_T type.
+
+Returns: void */
+static void dlx_init(Dlx_T *dlx) {
+    int c;
+
+    assert(dlx);
+    for (c = 0; c <= DLX_COLUMNS; c++) {
+        dlx->left[c] = c - 1;
+        dlx->right[c] = c + 1;
+        dlx->up[c] = c;
+        dlx->down[c] = c;
+        dlx->col[c] = c;
+        dlx->size[c] = 0;
+    }
+    dlx->left[0] = DLX_COLUMNS;
+    dlx->right[DLX_COLUMNS] = 0;
+    dlx->count = DLX_COLUMNS + 1;
+    return;
+}
+
+
+/* dlx_add_candidate
+
+Adds a matrix row for value val in cell (row, col). The row has a node in the
+column of each constraint that the candidate satisfies.
+
+Checks: if dlx is NULL.
+        if 0 <= row < SIZE.
+        if 0 <= col < SIZE.
+        if 1 <= val <= SIZE.
+
+Parameters:
+dlx: pointer to a Dlx_T type.
+row: row index.
+col: column index.
+val: the candidate value.
+
+Returns: void */
+static void dlx_add_candidate(Dlx_T *dlx, int row, int col, int val) {
+    int i, n, c, first, columns[4];
+
+    assert(dlx);
+    assert(row >= 0 && row < SIZE);
+    assert(col >= 0 && col < SIZE);
+    assert(val >= 1 && val <= SIZE);
+
+    /* cell, row-value, column-value and block-value constraints */
+    columns[0] = 1 + row * SIZE + col;
+    columns[1] = 1 + SIZE * SIZE + row * SIZE + val - 1;
+    columns[2] = 1 + 2 * SIZE * SIZE + col * SIZE + val - 1;
+    columns[3] = 1 + 3 * SIZE * SIZE + BLOCK(row, col) * SIZE + val - 1;
+
+    first = dlx->count;
+    for (i = 0; i < 4; i++) {
+        n = dlx->count++;
+        c = columns[i];
+
+        /* insert at the bottom of column c */
+        dlx->col[n] = c;
+        dlx->cand[n] = (row * SIZE + col) * SIZE + val - 1;
+        dlx->down[n] = c;
+        dlx->up[n] = dlx->up[c];
+        dlx->down[dlx->up[c]] = n;
+        dlx->up[c] = n;
+        dlx->size[c]++;
+
+        /* insert at the end of the matrix row */
+        if (n == first) {
+            dlx->left[n] = dlx->right[n] = n;
+            continue;
+        }
+        dlx->left[n] = n - 1;
+        dlx->right[n] = first;
+        dlx->right[n - 1] = n;
+        dlx->left[first] = n;
+    }
+    return;
+}
+
+
+/* dlx_cover
+
+Removes column c from the header list and all rows that have a node in
+column c from the other columns.
+
+Checks: if dlx is NULL.
+
+Parameters:
+dlx: pointer to a Dlx_T type.
+c: column header.
+
+Returns: void */
+static void dlx_cover(Dlx_T *dlx, int c) {
+    int i, j;
+
+    assert(dlx);
+    dlx->right[dlx->left[c]] = dlx->right[c];
+    dlx->left[dlx->right[c]] = dlx->left[c];
+    for (i = dlx->down[c]; i != c; i = dlx->down[i]) {
+        for (j = dlx->right[i]; j != i; j = dlx->right[j]) {
+            dlx->down[dlx->up[j]] = dlx->down[j];
+            dlx->up[dlx->down[j]] = dlx->up[j];
+            dlx->size[dlx->col[j]]--;
+        }
+    }
+    return;
+}
+
+
+/* dlx_uncover
+
+Reverts dlx_cover for column c. Columns must be uncovered in the reverse
+order they were covered.
+
+Checks: if dlx is NULL.
+
+Parameters:
+dlx: pointer to a Dlx_T type.
+c: column header.
+
+Returns: void */
+static void dlx_uncover(Dlx_T *dlx, int c) {
+    int i, j;
+
+    assert(dlx);
+    for (i = dlx->up[c]; i != c; i = dlx->up[i]) {
+        for (j = dlx->left[i]; j != i; j = dlx->left[j]) {
+            dlx->size[dlx->col[j]]++;
+            dlx->down[dlx->up[j]] = j;
+            dlx->up[dlx->down[j]] = j;
+        }
+    }
+    dlx->right[dlx->left[c]] = c;
+    dlx->left[dlx->right[c]] = c;
+    return;
+}
+
+
+/* dlx_search
+
+Searches recursively for a set of rows that covers every column exactly once.
+
+Checks: if dlx is NULL.
+
+Parameters:
+dlx: pointer to a Dlx_T type.
+depth: number of rows selected so far.
+
+Returns: 1 if a solution was found, 0 otherwise. The selected candidates are
+stored in sol[0] to sol[SIZE*SIZE - 1]. If the search was stopped, the
+matrix is left with covered columns and must not be searched again. */
+static int dlx_search(Dlx_T *dlx, int depth) {
+    int c, j, min, r;
+
+    assert(dlx);
+
+    /* all columns are covered */
+    if (dlx->right[0] == 0) {
+        return 1;
+    }
+
+    /* pick the column that has the fewest rows */
+    min = DLX_ROWS + 1;
+    c = 0;
+    for (j = dlx->right[0]; j != 0; j = dlx->right[j]) {
+        if (dlx->size[j] < min) {
+            min = dlx->size[j];
+            c = j;
+        }
+    }
+    if (min == 0) {
+        return 0;
+    }
+
+    dlx_cover(dlx, c);
+    for (r = dlx->down[c]; r != c; r = dlx->down[r]) {
+        (*dlx->nodes)++;
+        if (dlx->aborted && dlx->aborted(dlx->data)) {
+            dlx->stopped = 1;
+            return 0;
+        }
+        dlx->sol[depth] = dlx->cand[r];
+        for (j = dlx->right[r]; j != r; j = dlx->right[j]) {
+            dlx_cover(dlx, dlx->col[j]);
+        }
+        if (dlx_search(dlx, depth + 1)) {
+            return 1;
+        }
+        if (dlx->stopped) {
+            return 0;
+        }
+        for (j = dlx->left[r]; j != r; j = dlx->left[j]) {
+            dlx_uncover(dlx, dlx->col[j]);
+        }
+    }
+    dlx_uncover(dlx, c);
+    return 0;
+}
+
+
+/* dlx_solve
+
+Solves the given sudoku using Knuth's Algorithm X with Dancing Links.
+
+The sudoku is encoded as an exact cover matrix that has a column for each
+constraint and a row for each (cell, value) candidate that does not conflict
+with the filled-in cells. The search always covers the column that has the
+fewest rows.
+
+The given sudoku must not violate any rule.
+
+Checks: if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid.
+nodes: if not NULL, it is increased by the number of rows that were tried by
+the search, before each row is tried.
+aborted: if not NULL, it is called with data before each row is tried, and
+the search stops without a solution as soon as it returns nonzero.
+data: the argument of aborted.
+
+Returns: 1 if a solution was found and stored in solved, 0 otherwise. If no
+solution was found, solved is not modified. */
+int dlx_solve(const Grid_T *grid, Grid_T *solved, unsigned long *nodes,
+              int (*aborted)(void *data), void *data) {
+    int row, col, val, i, found;
+    unsigned long tried = 0;
+    Choices_T used;
+    Dlx_T *dlx;
+
+    assert(grid);
+    assert(solved);
+    dlx = malloc(sizeof(Dlx_T));
+    assert(dlx);
+
+    /* a filled-in cell has only its value as a candidate. An empty cell has
+    the values that are not used in its row, column and block */
+    dlx_init(dlx);
+    for (row = 0; row < SIZE; row++) {
+        for (col = 0; col < SIZE; col++) {
+            val = grid_read_value_p(grid, row, col);
+            if (val) {
+                dlx_add_candidate(dlx, row, col, val);
+                continue;
+            }
+            used = grid_read_used_p(grid, row, col);
+            for (val = 1; val <= SIZE; val++) {
+                if (!(used & CHOICE_BIT(val))) {
+                    dlx_add_candidate(dlx, row, col, val);
+                }
+            }
+        }
+    }
+
+    dlx->nodes = nodes ? nodes : &tried;
+    dlx->aborted = aborted;
+    dlx->data = data;
+    dlx->stopped = 0;
+    found = dlx_search(dlx, 0);
+    if (found) {
+        if (solved != grid) {
+            *solved = *grid;
+        }
+        for (i = 0; i < SIZE * SIZE; i++) {
+            row = dlx->sol[i] / (SIZE * SIZE);
+            col = dlx->sol[i] / SIZE % SIZE;
+            val = dlx->sol[i] % SIZE + 1;
+            grid_update_value(solved, row, col, val);
+            grid_clear_count(solved, row, col);
+        }
+    }
+    free(dlx);
+    return found;
+}
@@ -0,0 +1,46 @@
+/* Dancing Links interface: Solves a sudoku grid as an exact cover problem */
+
+#ifndef _DLX_H_
+#define _DLX_H_
+
+#include "grid.h"
+
+/* number of constraints (columns of the exact cover matrix): each cell has a
+value, each row/column/block has each value exactly once */
+#define DLX_COLUMNS (4 * SIZE * SIZE)
+
+/* max number of candidates (rows of the exact cover matrix): a value for
+each cell */
+#define DLX_ROWS (SIZE * SIZE * SIZE)
+
+
+/* dlx_solve
+
+Solves the given sudoku using Knuth's Algorithm X with Dancing Links.
+
+The sudoku is encoded as an exact cover matrix that has a column for each
+constraint and a row for each (cell, value) candidate that does not conflict
+with the filled-in cells. The search always covers the column that has the
+fewest rows.
+
+The given sudoku must not violate any rule.
+
+Checks: if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid.
+nodes: if not NULL, it is increased by the number of rows that were tried by
+the search, before each row is tried.
+aborted: if not NULL, it is called with data before each row is tried, and
+the search stops without a solution as soon as it returns nonzero.
+data: the argument of aborted.
+
+Returns: 1 if a solution was found and stored in solved, 0 otherwise. If no
+solution was found, solved is not modified. */
+int dlx_solve(const Grid_T *grid, Grid_T *solved, unsigned long *nodes,
+              int (*aborted)(void *data), void *data);
+
+
+#endif
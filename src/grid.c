@@ -4,10 +4,149 @@
 #include <assert.h>
 #include "grid.h"
 
+static void grid_rescan_units(Grid_T *grid, int i, int j);
+static int grid_cell_key(const Grid_T *grid, int cell);
+static void grid_queue_update(Grid_T *grid, int cell, int key);
+
+
+/* grid_init
+
+Initializes grid to an empty puzzle: all cells are empty and have no choices,
+the unique field is set to -1, the rulesok and rulescached fields are set
+to 1 and the initialized field is set to 0. Must be called before any other grid
+function.
+
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a Grid_T type
+
+Returns: void */
+void grid_init(Grid_T *grid) {
+    int i;
+
+    assert(grid);
+    for (i = 0; i < SIZE; i++) {
+        grid->rows[i] = 0;
+        grid->cols[i] = 0;
+        grid->blocks[i] = 0;
+    }
+
+    /* all cells are empty and have no choices, so their key is 0 */
+    for (i = 0; i < SIZE * SIZE; i++) {
+        grid->elts[i].val = 0;
+        grid->elts[i].choices = 0;
+        grid->cells[i] = (Cell_T) i;
+        grid->cell_pos[i] = (Cell_T) i;
+    }
+    grid->bucket[0] = 0;
+    for (i = 1; i < SIZE + 3; i++) {
+        grid->bucket[i] = SIZE * SIZE;
+    }
+    grid->unique = -1;
+    grid->rulesok = 1;
+    grid->rulescached = 1;
+    grid->initialized = 0;
+    return;
+}
+
+
+/* grid_rescan_units
+
+Recomputes the used values of the row, column and block of grid cell (i, j)
+by scanning their cells.
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a Grid_T type
+i: row index
+j: column index
+
+Returns: void */
+static void grid_rescan_units(Grid_T *grid, int i, int j) {
+    int k, b, brow, bcol;
+
+    assert(grid);
+    assert(i >= 0 && i < SIZE);
+    assert(j >= 0 && j < SIZE);
+    b = BLOCK(i, j);
+    grid->rows[i] = grid->cols[j] = grid->blocks[b] = 0;
+    for (k = 0; k < SIZE; k++) {
+        brow = SUBB(i) + k / BSIZE;
+        bcol = SUBB(j) + k % BSIZE;
+        grid->rows[i] |= CHOICE_BIT(grid->elts[i * SIZE + k].val);
+        grid->cols[j] |= CHOICE_BIT(grid->elts[k * SIZE + j].val);
+        grid->blocks[b] |= CHOICE_BIT(grid->elts[brow * SIZE + bcol].val);
+    }
+
+    /* bit 0 is set by empty cells */
+    grid->rows[i] &= CHOICES_ALL;
+    grid->cols[j] &= CHOICES_ALL;
+    grid->blocks[b] &= CHOICES_ALL;
+    return;
+}
+
+
+/* grid_cell_key
+
+Finds the key of the given grid cell in the bucket queue of the grid (see
+Grid_T): its number of choices if it is empty, SIZE+1 otherwise.
+
+Parameters:
+grid: pointer to a constant Grid_T type
+cell: cell index row * SIZE + col
+
+Returns: a key from 0 to SIZE+1 */
+static int grid_cell_key(const Grid_T *grid, int cell) {
+    if (grid->elts[cell].val) {
+        return SIZE + 1;
+    }
+    return grid_count_choices(grid->elts[cell].choices);
+}
+
+
+/* grid_queue_update
+
+Moves the given grid cell from the bucket of the given key to the bucket of
+its current key. The cell moves one bucket at a time: it swaps places with
+the last (or first) cell of its bucket, which then ends (or starts) one
+position earlier (or later).
+
+Parameters:
+grid: pointer to a Grid_T type
+cell: cell index row * SIZE + col
+key: the key of the cell before its value or choices were changed
+
+Returns: void */
+static void grid_queue_update(Grid_T *grid, int cell, int key) {
+    int pos, end, other;
+
+    end = grid_cell_key(grid, cell);
+    while (key != end) {
+        if (key < end) {
+            pos = --grid->bucket[++key];
+        }
+        else {
+            pos = grid->bucket[key--]++;
+        }
+        other = grid->cells[pos];
+        grid->cells[grid->cell_pos[cell]] = (Cell_T) other;
+        grid->cell_pos[other] = grid->cell_pos[cell];
+        grid->cells[pos] = (Cell_T) cell;
+        grid->cell_pos[cell] = (Cell_T) pos;
+    }
+    return;
+}
+
 
 /* grid_update_value
 
-Sets the value of grid cell (i, j) to n.
+Sets the value of grid cell (i, j) to n and updates the used values of its
+row, column and block. Clears the rulesok field if n is already used in the
+same row, column or block.
 
 Checks: if grid is NULL
         if 0 <= i < SIZE
@@ -22,19 +161,76 @@ n:
 
 Returns: void */
 void grid_update_value(Grid_T *grid, int i, int j, int n) {
+    int old, b, cell, key;
+
     assert(grid);
     assert(i >= 0 && i < SIZE);
     assert(j >= 0 && j < SIZE);
     assert(n >= 0 && n <= SIZE);
-    grid->elts[i][j].val = n;
+    cell = i * SIZE + j;
+    old = grid->elts[cell].val;
+    if (old == n) {
+        return;
+    }
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].val = 0;
+
+    /* if the puzzle has no duplicates, the old value is not used by other
+    cells of the same row, column and block. Else rescan the units, and since
+    removing a duplicate may fix the puzzle, it is not known if it is correct.
+    A rulesok that was set by the caller is not trusted */
+    if (old && grid->rulesok == 1 && grid->rulescached) {
+        b = BLOCK(i, j);
+        grid->rows[i] &= (Choices_T) ~CHOICE_BIT(old);
+        grid->cols[j] &= (Choices_T) ~CHOICE_BIT(old);
+        grid->blocks[b] &= (Choices_T) ~CHOICE_BIT(old);
+    }
+    else if (old) {
+        grid_rescan_units(grid, i, j);
+        grid->rulesok = -1;
+    }
+    if (n) {
+        b = BLOCK(i, j);
+        if ((grid->rows[i] | grid->cols[j] | grid->blocks[b]) & CHOICE_BIT(n)) {
+            grid->rulesok = 0;
+        }
+        grid->rows[i] |= CHOICE_BIT(n);
+        grid->cols[j] |= CHOICE_BIT(n);
+        grid->blocks[b] |= CHOICE_BIT(n);
+        grid->elts[cell].val = n;
+    }
+    grid_queue_update(grid, cell, key);
     return;
 }
 
 
-/* grid_read_value
+/* grid_read_value_p
 
 Reads the value of grid cell (i, j).
 
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+
+Returns: a value from 0 to SIZE */
+int grid_read_value_p(const Grid_T *grid, int i, int j) {
+    assert(grid);
+    assert(i >= 0 && i < SIZE);
+    assert(j >= 0 && j < SIZE);
+    return grid->elts[i * SIZE + j].val;
+}
+
+
+/* grid_read_value
+
+Reads the value of grid cell (i, j). Same as grid_read_value_p() for a grid
+passed by value.
+
 Checks: if 0 <= i < SIZE
         if 0 <= j < SIZE
 
@@ -45,15 +241,13 @@ j: column index
 
 Returns: a value from 0 to SIZE */
 int grid_read_value(Grid_T grid, int i, int j) {
-    assert(i >= 0 && i < SIZE);
-    assert(j >= 0 && j < SIZE);
-    return grid.elts[i][j].val;
+    return grid_read_value_p(&grid, i, j);
 }
 
 
 /* grid_set_choice
 
-Enables choice n for grid cell (i, j).
+Enables choice n for grid cell (i, j). Choice 0 is never enabled.
 
 Checks: if grid is NULL
         if 0 <= i < SIZE
@@ -68,11 +262,16 @@ n:
 
 Returns: void */
 void grid_set_choice(Grid_T *grid, int i, int j, int n) {
+    int cell, key;
+
     assert(grid);
     assert(i >= 0 && i < SIZE);
     assert(j >= 0 && j < SIZE);
     assert(n >= 0 && n <= SIZE);
-    grid->elts[i][j].choices.num[n] = 1;
+    cell = i * SIZE + j;
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].choices |= CHOICE_BIT(n) & CHOICES_ALL;
+    grid_queue_update(grid, cell, key);
     return;
 }
 
@@ -94,35 +293,63 @@ n:
 
 Returns: void */
 void grid_clear_choice(Grid_T *grid, int i, int j, int n) {
+    int cell, key;
+
     assert(grid);
     assert(i >= 0 && i < SIZE);
     assert(j >= 0 && j < SIZE);
     assert(n >= 0 && n <= SIZE);
-    grid->elts[i][j].choices.num[n] = 0;
+    cell = i * SIZE + j;
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].choices &= (Choices_T) ~CHOICE_BIT(n);
+    grid_queue_update(grid, cell, key);
     return;
 }
 
 
-/* grid_choice_is_valid
+/* grid_choice_is_valid_p
 
 Finds if n is an available choice for grid cell (i, j).
 
-Checks: if 0 <= i < SIZE
+Checks: if grid is NULL
+        if 0 <= i < SIZE
         if 0 <= j < SIZE
         if 0 <= n <= SIZE
 
 Parameters:
-grid: a Grid_T type
+grid: pointer to a constant Grid_T type
 i: row index
 j: column index
 n:
 
 Returns: 1 or 0 indicating whether a choice is valid or not */
-int grid_choice_is_valid(Grid_T grid, int i, int j, int n) {
+int grid_choice_is_valid_p(const Grid_T *grid, int i, int j, int n) {
+    assert(grid);
     assert(i >= 0 && i < SIZE);
     assert(j >= 0 && j < SIZE);
     assert(n >= 0 && n <= SIZE);
-    return grid.elts[i][j].choices.num[n];
+    return (grid->elts[i * SIZE + j].choices & CHOICE_BIT(n)) != 0;
+}
+
+
+/* grid_choice_is_valid
+
+Finds if n is an available choice for grid cell (i, j). Same as
+grid_choice_is_valid_p() for a grid passed by value.
+
+Checks: if 0 <= i < SIZE
+        if 0 <= j < SIZE
+        if 0 <= n <= SIZE
+
+Parameters:
+grid: a Grid_T type
+i: row index
+j: column index
+n:
+
+Returns: 1 or 0 indicating whether a choice is valid or not */
+int grid_choice_is_valid(Grid_T grid, int i, int j, int n) {
+    return grid_choice_is_valid_p(&grid, i, j, n);
 }
 
 
@@ -144,22 +371,47 @@ n:
 
 Returns: void */
 void grid_remove_choice(Grid_T *grid, int i, int j, int n) {
+    int cell, key;
+
     assert(grid);
     assert(i >= 0 && i < SIZE);
     assert(j >= 0 && j < SIZE);
     assert(n >= 0 && n <= SIZE);
-    if (grid->elts[i][j].choices.num[n]) {
-        grid->elts[i][j].choices.num[n] = 0;
-        grid->elts[i][j].choices.count--;
-    }
+    cell = i * SIZE + j;
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].choices &= (Choices_T) ~CHOICE_BIT(n);
+    grid_queue_update(grid, cell, key);
     return;
 }
 
 
-/* grid_read_count
+/* grid_read_count_p
 
 Reads the available choices for grid cell(i, j).
 
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+
+Returns: the number of available choices for grid cell (i, j) */
+int grid_read_count_p(const Grid_T *grid, int i, int j) {
+    assert(grid);
+    assert(i >= 0 && i < SIZE);
+    assert(j >= 0 && j < SIZE);
+    return grid_count_choices(grid->elts[i * SIZE + j].choices);
+}
+
+
+/* grid_read_count
+
+Reads the available choices for grid cell(i, j). Same as grid_read_count_p()
+for a grid passed by value.
+
 Checks: if 0 <= i < SIZE
         if 0 <= j < SIZE
 
@@ -170,15 +422,151 @@ j: column index
 
 Returns: the number of available choices for grid cell (i, j) */
 int grid_read_count(Grid_T grid, int i, int j) {
+    return grid_read_count_p(&grid, i, j);
+}
+
+
+/* grid_read_choices_p
+
+Reads the available choices for grid cell (i, j) as a bitmask.
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+
+Returns: a bitmask that has bit n set if n is a valid choice */
+Choices_T grid_read_choices_p(const Grid_T *grid, int i, int j) {
+    assert(grid);
     assert(i >= 0 && i < SIZE);
     assert(j >= 0 && j < SIZE);
-    return grid.elts[i][j].choices.count;
+    return grid->elts[i * SIZE + j].choices;
+}
+
+
+/* grid_read_choices
+
+Reads the available choices for grid cell (i, j) as a bitmask. Same as
+grid_read_choices_p() for a grid passed by value.
+
+Checks: if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: a Grid_T type
+i: row index
+j: column index
+
+Returns: a bitmask that has bit n set if n is a valid choice */
+Choices_T grid_read_choices(Grid_T grid, int i, int j) {
+    return grid_read_choices_p(&grid, i, j);
+}
+
+
+/* grid_write_choices
+
+Sets the available choices for grid cell (i, j) to the given bitmask.
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+        if choices is a subset of CHOICES_ALL
+
+Parameters:
+grid: pointer to a Grid_T type
+i: row index
+j: column index
+choices: a bitmask that has bit n set if n is a valid choice
+
+Returns: void */
+void grid_write_choices(Grid_T *grid, int i, int j, Choices_T choices) {
+    int cell, key;
+
+    assert(grid);
+    assert(i >= 0 && i < SIZE);
+    assert(j >= 0 && j < SIZE);
+    assert(!(choices & (Choices_T) ~CHOICES_ALL));
+    cell = i * SIZE + j;
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].choices = choices;
+    grid_queue_update(grid, cell, key);
+    return;
+}
+
+
+/* grid_count_choices
+
+Counts the choices in the given bitmask.
+
+Parameters:
+choices: a bitmask of choices
+
+Returns: the number of set bits */
+int grid_count_choices(Choices_T choices) {
+#if defined(__GNUC__)
+    return __builtin_popcountl(choices);
+#else
+    int count;
+
+    /* clear the lowest set bit until none is left */
+    for (count = 0; choices; count++) {
+        choices &= choices - 1;
+    }
+    return count;
+#endif
+}
+
+
+/* grid_read_used_p
+
+Reads the values used in the row, column and block of grid cell (i, j).
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+
+Returns: a bitmask that has bit n set if n is the value of a cell in the
+same row, column or block as (i, j) */
+Choices_T grid_read_used_p(const Grid_T *grid, int i, int j) {
+    assert(grid);
+    assert(i >= 0 && i < SIZE);
+    assert(j >= 0 && j < SIZE);
+    return grid->rows[i] | grid->cols[j] | grid->blocks[BLOCK(i, j)];
+}
+
+
+/* grid_read_row_used_p
+
+Reads the values used in row i.
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+
+Returns: a bitmask that has bit n set if n is the value of a cell in row i */
+Choices_T grid_read_row_used_p(const Grid_T *grid, int i) {
+    assert(grid);
+    assert(i >= 0 && i < SIZE);
+    return grid->rows[i];
 }
 
 
 /* grid_set_count
 
-Sets the number of available choices for grid cell (i, j) to SIZE.
+Enables all choices from 1 to SIZE for grid cell (i, j), so that the number of
+available choices becomes SIZE.
 
 Checks: if grid is NULL
         if 0 <= i < SIZE
@@ -191,17 +579,23 @@ j: column index
 
 Returns: void */
 void grid_set_count(Grid_T *grid, int i, int j) {
+    int cell, key;
+
     assert(grid);
     assert(i >= 0 && i < SIZE);
     assert(j >= 0 && j < SIZE);
-    grid->elts[i][j].choices.count = SIZE;
+    cell = i * SIZE + j;
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].choices = CHOICES_ALL;
+    grid_queue_update(grid, cell, key);
     return;
 }
 
 
 /* grid_clear_count
 
-Sets the number of available choices for grid cell (i, j) to 0.
+Clears all choices for grid cell (i, j), so that the number of available
+choices becomes 0.
 
 Checks: if grid is NULL
         if 0 <= i < SIZE
@@ -214,18 +608,183 @@ j: column index
 
 Returns: void */
 void grid_clear_count(Grid_T *grid, int i, int j) {
+    int cell, key;
+
     assert(grid);
     assert(i >= 0 && i < SIZE);
     assert(j >= 0 && j < SIZE);
-    grid->elts[i][j].choices.count = 0;
+    cell = i * SIZE + j;
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].choices = 0;
+    grid_queue_update(grid, cell, key);
     return;
 }
 
 
-/* grid_read_unique
+/* grid_count_cells_p
+
+Counts the empty cells of grid that have count available choices, using the
+bucket queue of the grid.
+
+Checks: if grid is NULL
+        if 0 <= count <= SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+count: number of choices
+
+Returns: the number of cells */
+int grid_count_cells_p(const Grid_T *grid, int count) {
+    assert(grid);
+    assert(count >= 0 && count <= SIZE);
+    return grid->bucket[count + 1] - grid->bucket[count];
+}
+
+
+/* grid_read_cell_p
+
+Reads one of the empty cells of grid that have count available choices. The
+order of these cells changes whenever the value or the choices of a cell
+change.
+
+Checks: if grid is NULL
+        if 0 <= count <= SIZE
+        if 0 <= k < grid_count_cells_p(grid, count)
+
+Parameters:
+grid: pointer to a constant Grid_T type
+count: number of choices
+k: index of the cell among the cells that have count choices
+
+Returns: the index row * SIZE + col of the cell */
+int grid_read_cell_p(const Grid_T *grid, int count, int k) {
+    assert(grid);
+    assert(count >= 0 && count <= SIZE);
+    assert(k >= 0 && k < grid->bucket[count + 1] - grid->bucket[count]);
+    return grid->cells[grid->bucket[count] + k];
+}
+
+
+/* grid_read_cell_value_p
+
+Reads the value of the given grid cell. Same as grid_read_value_p() for a
+cell given by its index.
+
+Checks: if grid is NULL
+        if 0 <= cell < SIZE*SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+cell: cell index row * SIZE + col
+
+Returns: a value from 0 to SIZE */
+int grid_read_cell_value_p(const Grid_T *grid, int cell) {
+    assert(grid);
+    assert(cell >= 0 && cell < SIZE * SIZE);
+    return grid->elts[cell].val;
+}
+
+
+/* grid_read_cell_choices_p
+
+Reads the available choices of the given grid cell. Same as
+grid_read_choices_p() for a cell given by its index.
+
+Checks: if grid is NULL
+        if 0 <= cell < SIZE*SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+cell: cell index row * SIZE + col
+
+Returns: a bitmask that has bit n set if n is a valid choice */
+Choices_T grid_read_cell_choices_p(const Grid_T *grid, int cell) {
+    assert(grid);
+    assert(cell >= 0 && cell < SIZE * SIZE);
+    return grid->elts[cell].choices;
+}
+
+
+/* grid_remove_cell_choice
+
+Removes choice n from the given grid cell. Same as grid_remove_choice() for a
+cell given by its index.
+
+Checks: if grid is NULL
+        if 0 <= cell < SIZE*SIZE
+        if 0 <= n <= SIZE
+
+Parameters:
+grid: pointer to a Grid_T type
+cell: cell index row * SIZE + col
+n: the removed choice
+
+Returns: void */
+void grid_remove_cell_choice(Grid_T *grid, int cell, int n) {
+    int key;
+
+    assert(grid);
+    assert(cell >= 0 && cell < SIZE * SIZE);
+    assert(n >= 0 && n <= SIZE);
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].choices &= (Choices_T) ~CHOICE_BIT(n);
+    grid_queue_update(grid, cell, key);
+    return;
+}
+
+
+/* grid_write_cell_choices
+
+Sets the available choices of the given grid cell. Same as
+grid_write_choices() for a cell given by its index.
+
+Checks: if grid is NULL
+        if 0 <= cell < SIZE*SIZE
+        if choices has no bits other than 1 to SIZE
+
+Parameters:
+grid: pointer to a Grid_T type
+cell: cell index row * SIZE + col
+choices: a bitmask that has bit n set if n is a valid choice
+
+Returns: void */
+void grid_write_cell_choices(Grid_T *grid, int cell, Choices_T choices) {
+    int key;
+
+    assert(grid);
+    assert(cell >= 0 && cell < SIZE * SIZE);
+    assert(!(choices & (Choices_T) ~CHOICES_ALL));
+    key = grid_cell_key(grid, cell);
+    grid->elts[cell].choices = choices;
+    grid_queue_update(grid, cell, key);
+    return;
+}
+
+
+/* grid_read_unique_p
 
 Reads the unique field of grid.
 
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns:
+- 1 if grid has a unique choice solution.
+- 0 if it grid does not have a unique choice solution.
+- else -1. */
+int grid_read_unique_p(const Grid_T *grid) {
+    assert(grid);
+    return grid->unique;
+}
+
+
+/* grid_read_unique
+
+Reads the unique field of grid. Same as grid_read_unique_p() for a grid passed
+by value.
+
 Parameters:
 grid: a Grid_T type
 
@@ -234,7 +793,7 @@ Returns:
 - 0 if it grid does not have a unique choice solution.
 - else -1. */
 int grid_read_unique(Grid_T grid) {
-    return grid.unique;
+    return grid_read_unique_p(&grid);
 }
 
 
@@ -305,6 +864,7 @@ Returns: void */
 void grid_set_rulesok(Grid_T *grid) {
     assert(grid);
     grid->rulesok = 1;
+    grid->rulescached = 0;
 }
 
 
@@ -322,6 +882,7 @@ Returns: void */
 void grid_clear_rulesok(Grid_T *grid) {
     assert(grid);
     grid->rulesok = 0;
+    grid->rulescached = 0;
 }
 
 
@@ -339,20 +900,56 @@ Returns: void */
 void grid_reset_rulesok(Grid_T *grid) {
     assert(grid);
     grid->rulesok = -1;
+    grid->rulescached = 0;
 }
 
 
-/* grid_read_rulesok
+/* grid_read_rulesok_p
 
 Reads the rulesok field of grid.
 
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns: 1 if grid does not violate any sudoku rule. 0 if grid violates
+at least one rule, -1 otherwise */
+int grid_read_rulesok_p(const Grid_T *grid) {
+    assert(grid);
+    return grid->rulesok;
+}
+
+
+/* grid_read_rulesok
+
+Reads the rulesok field of grid. Same as grid_read_rulesok_p() for a grid
+passed by value.
+
 Parameters:
 grid: a Grid_T type
 
 Returns: 1 if grid does not violate any sudoku rule. 0 if grid violates
 at least one rule, -1 otherwise */
 int grid_read_rulesok(Grid_T grid) {
-    return grid.rulesok;
+    return grid_read_rulesok_p(&grid);
+}
+
+
+/* grid_rulesok_is_cached_p
+
+Reads the rulescached field of grid.
+
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns: 1 if the rulesok field follows from the values of grid, 0 if it was
+set by the caller */
+int grid_rulesok_is_cached_p(const Grid_T *grid) {
+    assert(grid);
+    return grid->rulescached;
 }
 
 
@@ -390,15 +987,33 @@ void grid_clear_initialized(Grid_T *grid) {
 }
 
 
-/* grid_is_initialized
+/* grid_is_initialized_p
 
 Reads the initialized field of grid.
 
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns: 1 if the available choices for each cell have been computed,
+0 otherwise */
+int grid_is_initialized_p(const Grid_T *grid) {
+    assert(grid);
+    return grid->initialized;
+}
+
+
+/* grid_is_initialized
+
+Reads the initialized field of grid. Same as grid_is_initialized_p() for a grid
+passed by value.
+
 Parameters:
 grid: a Grid_T type
 
 Returns: 1 if the available choices for each cell have been computed,
 0 otherwise */
 int grid_is_initialized(Grid_T grid) {
-    return grid.initialized;
+    return grid_is_initialized_p(&grid);
 }
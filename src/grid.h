@@ -4,13 +4,56 @@
 #define _GRID_H_
 
 #include <stdio.h>
+#include <limits.h>
 
-#define SIZE 9      /* grid size 9x9 */
-#define BSIZE 3     /* grid block size 3x3 */
+/* grid block size BSIZExBSIZE. The library is compiled once for each block
+size from 2 (4x4 grids) to 5 (25x25 grids) by defining BSIZE on the command
+line, see variant.h */
+#ifndef BSIZE
+#define BSIZE 3
+#endif
+
+#if BSIZE < 2 || BSIZE > 5
+#error "BSIZE must be between 2 and 5"
+#endif
+
+#define SIZE (BSIZE * BSIZE)    /* grid size SIZExSIZE */
+
+#include "variant.h"
 
 /* calculates the maximum multiple of BSIZE that is less than i */
 #define SUBB(i) (((i)/BSIZE) * BSIZE)
 
+/* index of the block that contains cell (i, j). Blocks are numbered from left
+to right and top to bottom */
+#define BLOCK(i, j) (SUBB(i) + (j)/BSIZE)
+
+/* bitmask of the choices of a cell: bit n is set if n is an available choice.
+Bit 0 is never set. The smallest type that holds bits 1 to SIZE is used: 16
+bits up to 9x9 grids, 32 bits for 16x16 and 25x25 grids. */
+#if BSIZE <= 3
+typedef unsigned short Choices_T;
+#elif UINT_MAX >= 0xffffffffUL
+typedef unsigned int Choices_T;
+#else
+typedef unsigned long Choices_T;
+#endif
+
+/* index row * SIZE + col of a cell: 8 bits up to 9x9 grids, 16 bits for
+16x16 and 25x25 grids (a 16x16 grid has 256 cells, and the bounds of its
+bucket queue go up to 256) */
+#if BSIZE <= 3
+typedef unsigned char Cell_T;
+#else
+typedef unsigned short Cell_T;
+#endif
+
+/* the bit that corresponds to choice n */
+#define CHOICE_BIT(n) ((Choices_T) ((Choices_T) 1 << (n)))
+
+/* all choices from 1 to SIZE */
+#define CHOICES_ALL ((Choices_T) (((Choices_T) 1 << (SIZE + 1)) - 2))
+
 
 /* Struct that represents a sudoku puzzle.
 
@@ -24,6 +67,14 @@ Fields:
 -1: unknown whether puzzle violates any sudoku rules.
 0: puzzle violates a sudoku rule.
 1: puzzle does not violate any sudoku rule.
+It is kept up to date by grid_update_value: placing a value that is already
+used in the same row, column or block sets it to 0, and deleting a value from
+a puzzle that violates a rule sets it to -1.
+
+> rulescached: 1 if rulesok has only been changed by grid_init and
+grid_update_value, so that it follows from the values of the grid. 0 once
+it has been set with grid_set_rulesok, grid_clear_rulesok or
+grid_reset_rulesok, in which case it may not match the values.
 
 > initialized: 1 if the available choices for each cell have been computed,
 0 otherwise.
@@ -31,29 +82,66 @@ Fields:
 > val: value of a cell. Takes values from 0 to SIZE. A zero value means that
 the cell is empty.
 
-> count: number of possible choices for a cell.
-
-> num[SIZE+1]: num[k] = 1 if k is valid choice for a cell, else num[k] = 0.
-
-> elts[SIZE][SIZE]: the grid
+> choices: bitmask of the available choices for a cell. Bit k is set if k is
+a valid choice. The number of choices is the number of set bits.
+
+> elts[SIZE*SIZE]: the grid. Cell (i, j) is elts[i * SIZE + j], so a cell
+can also be given by the single index i * SIZE + j (see grid_read_cell_value_p)
+
+> rows[SIZE], cols[SIZE], blocks[SIZE]: bitmask of the values used in each
+row, column and block. Bit k is set if k is the value of a cell in that
+row/column/block. Kept up to date by grid_update_value.
+
+> cells[SIZE*SIZE], cell_pos[SIZE*SIZE], bucket[SIZE+3]: a bucket queue of
+the cells keyed by their number of choices, so that a cell with the min
+number of choices is found without scanning the grid. The key of an empty
+cell is its number of choices (0 to SIZE) and the key of a filled-in cell is
+SIZE+1. cells holds the indexes of all cells (row * SIZE + col) ordered by
+key: the cells of key k are cells[bucket[k]] to cells[bucket[k+1]-1].
+cell_pos[c] is the position of cell c in cells. Kept up to date by every
+function that changes the value or the choices of a cell: a cell moves to the
+next bucket by swapping places with the first or last cell of its bucket and
+moving the bound, in constant time.
 */
 typedef struct grid_s {
     int unique;
     int rulesok;
+    int rulescached;
     int initialized;
     struct {
-        int val;
-        struct {
-            int count;
-            int num[SIZE+1];
-        } choices;
-    } elts[SIZE][SIZE];
+        unsigned char val;
+        Choices_T choices;
+    } elts[SIZE * SIZE];
+    Choices_T rows[SIZE];
+    Choices_T cols[SIZE];
+    Choices_T blocks[SIZE];
+    Cell_T cells[SIZE * SIZE];
+    Cell_T cell_pos[SIZE * SIZE];
+    Cell_T bucket[SIZE + 3];
 } Grid_T;
 
 
+/* grid_init
+
+Initializes grid to an empty puzzle: all cells are empty and have no choices,
+the unique field is set to -1, the rulesok and rulescached fields are set
+to 1 and the initialized field is set to 0. Must be called before any other grid
+function.
+
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a Grid_T type
+
+Returns: void */
+void grid_init(Grid_T *grid);
+
+
 /* grid_update_value
 
-Sets the value of grid cell (i, j) to n.
+Sets the value of grid cell (i, j) to n and updates the used values of its
+row, column and block. Clears the rulesok field if n is already used in the
+same row, column or block.
 
 Checks: if grid is NULL
         if 0 <= i < SIZE
@@ -70,10 +158,28 @@ Returns: void */
 void grid_update_value(Grid_T *grid, int i, int j, int n);
 
 
-/* grid_read_value
+/* grid_read_value_p
 
 Reads the value of grid cell (i, j).
 
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+
+Returns: a value from 0 to SIZE */
+int grid_read_value_p(const Grid_T *grid, int i, int j);
+
+
+/* grid_read_value
+
+Reads the value of grid cell (i, j). Same as grid_read_value_p() for a grid
+passed by value.
+
 Checks: if 0 <= i < SIZE
         if 0 <= j < SIZE
 
@@ -88,7 +194,7 @@ int grid_read_value(Grid_T grid, int i, int j);
 
 /* grid_set_choice
 
-Enables choice n for grid cell (i, j).
+Enables choice n for grid cell (i, j). Choice 0 is never enabled.
 
 Checks: if grid is NULL
         if 0 <= i < SIZE
@@ -124,10 +230,30 @@ Returns: void */
 void grid_clear_choice(Grid_T *grid, int i, int j, int n);
 
 
-/* grid_choice_is_valid
+/* grid_choice_is_valid_p
 
 Finds if n is an available choice for grid cell (i, j).
 
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+        if 0 <= n <= SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+n:
+
+Returns: 1 or 0 indicating whether a choice is valid or not */
+int grid_choice_is_valid_p(const Grid_T *grid, int i, int j, int n);
+
+
+/* grid_choice_is_valid
+
+Finds if n is an available choice for grid cell (i, j). Same as
+grid_choice_is_valid_p() for a grid passed by value.
+
 Checks: if 0 <= i < SIZE
         if 0 <= j < SIZE
         if 0 <= n <= SIZE
@@ -162,10 +288,28 @@ Returns: void */
 void grid_remove_choice(Grid_T *grid, int i, int j, int n);
 
 
-/* grid_read_count
+/* grid_read_count_p
 
 Reads the available choices for grid cell(i, j).
 
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+
+Returns: the number of available choices for grid cell (i, j) */
+int grid_read_count_p(const Grid_T *grid, int i, int j);
+
+
+/* grid_read_count
+
+Reads the available choices for grid cell(i, j). Same as grid_read_count_p()
+for a grid passed by value.
+
 Checks: if 0 <= i < SIZE
         if 0 <= j < SIZE
 
@@ -178,9 +322,107 @@ Returns: the number of available choices for grid cell (i, j) */
 int grid_read_count(Grid_T grid, int i, int j);
 
 
+/* grid_read_choices_p
+
+Reads the available choices for grid cell (i, j) as a bitmask.
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+
+Returns: a bitmask that has bit n set if n is a valid choice */
+Choices_T grid_read_choices_p(const Grid_T *grid, int i, int j);
+
+
+/* grid_read_choices
+
+Reads the available choices for grid cell (i, j) as a bitmask. Same as
+grid_read_choices_p() for a grid passed by value.
+
+Checks: if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: a Grid_T type
+i: row index
+j: column index
+
+Returns: a bitmask that has bit n set if n is a valid choice */
+Choices_T grid_read_choices(Grid_T grid, int i, int j);
+
+
+/* grid_write_choices
+
+Sets the available choices for grid cell (i, j) to the given bitmask.
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+        if choices is a subset of CHOICES_ALL
+
+Parameters:
+grid: pointer to a Grid_T type
+i: row index
+j: column index
+choices: a bitmask that has bit n set if n is a valid choice
+
+Returns: void */
+void grid_write_choices(Grid_T *grid, int i, int j, Choices_T choices);
+
+
+/* grid_count_choices
+
+Counts the choices in the given bitmask.
+
+Parameters:
+choices: a bitmask of choices
+
+Returns: the number of set bits */
+int grid_count_choices(Choices_T choices);
+
+
+/* grid_read_used_p
+
+Reads the values used in the row, column and block of grid cell (i, j).
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+        if 0 <= j < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+j: column index
+
+Returns: a bitmask that has bit n set if n is the value of a cell in the
+same row, column or block as (i, j) */
+Choices_T grid_read_used_p(const Grid_T *grid, int i, int j);
+
+
+/* grid_read_row_used_p
+
+Reads the values used in row i.
+
+Checks: if grid is NULL
+        if 0 <= i < SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+i: row index
+
+Returns: a bitmask that has bit n set if n is the value of a cell in row i */
+Choices_T grid_read_row_used_p(const Grid_T *grid, int i);
+
+
 /* grid_set_count
 
-Sets the number of available choices for grid cell (i, j) to SIZE.
+Enables all choices from 1 to SIZE for grid cell (i, j), so that the number of
+available choices becomes SIZE.
 
 Checks: if grid is NULL
         if 0 <= i < SIZE
@@ -197,7 +439,8 @@ void grid_set_count(Grid_T *grid, int i, int j);
 
 /* grid_clear_count
 
-Sets the number of available choices for grid cell (i, j) to 0.
+Clears all choices for grid cell (i, j), so that the number of available
+choices becomes 0.
 
 Checks: if grid is NULL
         if 0 <= i < SIZE
@@ -212,10 +455,130 @@ Returns: void */
 void grid_clear_count(Grid_T *grid, int i, int j);
 
 
-/* grid_read_unique
+/* grid_count_cells_p
+
+Counts the empty cells of grid that have count available choices, using the
+bucket queue of the grid.
+
+Checks: if grid is NULL
+        if 0 <= count <= SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+count: number of choices
+
+Returns: the number of cells */
+int grid_count_cells_p(const Grid_T *grid, int count);
+
+
+/* grid_read_cell_p
+
+Reads one of the empty cells of grid that have count available choices. The
+order of these cells changes whenever the value or the choices of a cell
+change.
+
+Checks: if grid is NULL
+        if 0 <= count <= SIZE
+        if 0 <= k < grid_count_cells_p(grid, count)
+
+Parameters:
+grid: pointer to a constant Grid_T type
+count: number of choices
+k: index of the cell among the cells that have count choices
+
+Returns: the index row * SIZE + col of the cell */
+int grid_read_cell_p(const Grid_T *grid, int count, int k);
+
+
+/* grid_read_cell_value_p
+
+Reads the value of the given grid cell. Same as grid_read_value_p() for a
+cell given by its index.
+
+Checks: if grid is NULL
+        if 0 <= cell < SIZE*SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+cell: cell index row * SIZE + col
+
+Returns: a value from 0 to SIZE */
+int grid_read_cell_value_p(const Grid_T *grid, int cell);
+
+
+/* grid_read_cell_choices_p
+
+Reads the available choices of the given grid cell. Same as
+grid_read_choices_p() for a cell given by its index.
+
+Checks: if grid is NULL
+        if 0 <= cell < SIZE*SIZE
+
+Parameters:
+grid: pointer to a constant Grid_T type
+cell: cell index row * SIZE + col
+
+Returns: a bitmask that has bit n set if n is a valid choice */
+Choices_T grid_read_cell_choices_p(const Grid_T *grid, int cell);
+
+
+/* grid_remove_cell_choice
+
+Removes choice n from the given grid cell. Same as grid_remove_choice() for a
+cell given by its index.
+
+Checks: if grid is NULL
+        if 0 <= cell < SIZE*SIZE
+        if 0 <= n <= SIZE
+
+Parameters:
+grid: pointer to a Grid_T type
+cell: cell index row * SIZE + col
+n: the removed choice
+
+Returns: void */
+void grid_remove_cell_choice(Grid_T *grid, int cell, int n);
+
+
+/* grid_write_cell_choices
+
+Sets the available choices of the given grid cell. Same as
+grid_write_choices() for a cell given by its index.
+
+Checks: if grid is NULL
+        if 0 <= cell < SIZE*SIZE
+        if choices has no bits other than 1 to SIZE
+
+Parameters:
+grid: pointer to a Grid_T type
+cell: cell index row * SIZE + col
+choices: a bitmask that has bit n set if n is a valid choice
+
+Returns: void */
+void grid_write_cell_choices(Grid_T *grid, int cell, Choices_T choices);
+
+
+/* grid_read_unique_p
 
 Reads the unique field of grid.
 
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns:
+- 1 if grid has a unique choice solution.
+- 0 if it grid does not have a unique choice solution.
+- else -1. */
+int grid_read_unique_p(const Grid_T *grid);
+
+
+/* grid_read_unique
+
+Reads the unique field of grid. Same as grid_read_unique_p() for a grid passed
+by value.
+
 Parameters:
 grid: a Grid_T type
 
@@ -309,10 +672,25 @@ Returns: void */
 void grid_reset_rulesok(Grid_T *grid);
 
 
-/* grid_read_rulesok
+/* grid_read_rulesok_p
 
 Reads the rulesok field of grid.
 
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns: 1 if grid does not violate any sudoku rule. 0 if grid violates
+at least one rule, -1 otherwise */
+int grid_read_rulesok_p(const Grid_T *grid);
+
+
+/* grid_read_rulesok
+
+Reads the rulesok field of grid. Same as grid_read_rulesok_p() for a grid
+passed by value.
+
 Parameters:
 grid: a Grid_T type
 
@@ -321,6 +699,20 @@ at least one rule, -1 otherwise */
 int grid_read_rulesok(Grid_T grid);
 
 
+/* grid_rulesok_is_cached_p
+
+Reads the rulescached field of grid.
+
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns: 1 if the rulesok field follows from the values of grid, 0 if it was
+set by the caller */
+int grid_rulesok_is_cached_p(const Grid_T *grid);
+
+
 /* grid_set_initialized
 
 Sets the initialized field of grid to 1, meaning the available choices for each
@@ -349,10 +741,25 @@ Returns: void */
 void grid_clear_initialized(Grid_T *grid);
 
 
-/* grid_is_initialized
+/* grid_is_initialized_p
 
 Reads the initialized field of grid.
 
+Checks: if grid is NULL
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns: 1 if the available choices for each cell have been computed,
+0 otherwise */
+int grid_is_initialized_p(const Grid_T *grid);
+
+
+/* grid_is_initialized
+
+Reads the initialized field of grid. Same as grid_is_initialized_p() for a grid
+passed by value.
+
 Parameters:
 grid: a Grid_T type
 
@@ -0,0 +1,248 @@
+/* Thread pool interface: Runs a set of independent tasks on worker threads
+that balance the load with work stealing */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pool.h"
+
+
+/* Struct that represents the deque of a worker. The deque holds the task
+indices from front to back-1.
+
+Fields:
+> lock: protects front and back. The owner takes tasks from the front and
+thieves take tasks from the back.
+
+> front, back: the range of task indices.
+*/
+typedef struct pool_deque_s {
+    pthread_mutex_t lock;
+    int front;
+    int back;
+} Pool_Deque_T;
+
+
+/* Struct that holds the state shared by all workers of a pool_run call.
+
+Fields:
+> deques: the deque of each worker.
+
+> nthreads: number of workers.
+
+> task, arg: the function that runs a task and its argument.
+*/
+typedef struct pool_s {
+    Pool_Deque_T *deques;
+    int nthreads;
+    Pool_Task_T task;
+    void *arg;
+} Pool_T;
+
+
+/* Struct that is passed to a worker thread.
+
+Fields:
+> pool: the shared state.
+
+> id: the index of the worker.
+*/
+typedef struct pool_worker_s {
+    Pool_T *pool;
+    int id;
+} Pool_Worker_T;
+
+static int pool_pop(Pool_Deque_T *deque);
+static int pool_steal(Pool_T *pool, int id);
+static void *pool_worker(void *arg);
+
+
+/* pool_cpu_count
+
+Finds the number of online processors.
+
+Parameters: void
+
+Returns: the number of online processors, or 1 if it is not known. */
+int pool_cpu_count(void) {
+    long n;
+
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+
+/* pool_pop
+
+Takes the task at the front of the given deque.
+
+Checks: if deque is NULL.
+
+Parameters:
+deque: pointer to a Pool_Deque_T type.
+
+Returns: the task index, or -1 if the deque is empty. */
+static int pool_pop(Pool_Deque_T *deque) {
+    int index = -1;
+
+    assert(deque);
+    pthread_mutex_lock(&deque->lock);
+    if (deque->front < deque->back) {
+        index = deque->front++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return index;
+}
+
+
+/* pool_steal
+
+Steals the back half of the deque of another worker. The workers are
+visited in a round robin order that starts after worker id. The first stolen
+task is returned and the rest are moved to the (empty) deque of worker id.
+
+Checks: if pool is NULL.
+
+Parameters:
+pool: pointer to a Pool_T type.
+id: the index of the thief.
+
+Returns: a task index, or -1 if all other deques are empty. */
+static int pool_steal(Pool_T *pool, int id) {
+    int k, start, end;
+    Pool_Deque_T *victim, *own;
+
+    assert(pool);
+    own = &pool->deques[id];
+    for (k = 1; k < pool->nthreads; k++) {
+        victim = &pool->deques[(id + k) % pool->nthreads];
+        pthread_mutex_lock(&victim->lock);
+        end = victim->back;
+        start = end - (end - victim->front + 1) / 2;
+        if (start < end) {
+            victim->back = start;
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (start < end) {
+            pthread_mutex_lock(&own->lock);
+            own->front = start + 1;
+            own->back = end;
+            pthread_mutex_unlock(&own->lock);
+            return start;
+        }
+    }
+    return -1;
+}
+
+
+/* pool_worker
+
+Runs tasks from the deque of the worker, and stolen tasks when it is empty,
+until no task is left.
+
+Parameters:
+arg: pointer to a Pool_Worker_T type.
+
+Returns: NULL */
+static void *pool_worker(void *arg) {
+    Pool_Worker_T *worker = arg;
+    Pool_T *pool = worker->pool;
+    int index;
+
+    while ((index = pool_pop(&pool->deques[worker->id])) >= 0 ||
+           (index = pool_steal(pool, worker->id)) >= 0) {
+        pool->task(pool->arg, worker->id, index);
+    }
+    return NULL;
+}
+
+
+/* pool_run
+
+Runs task(arg, worker, index) for every index from 0 to ntasks-1 using
+nthreads threads, and returns when all tasks have finished. The calling
+thread is worker 0.
+
+Each worker has a deque of task indices that initially holds a contiguous
+range of ntasks/nthreads tasks. A worker takes tasks from the front of its
+own deque. When its deque is empty, it steals the back half of the deque of
+another worker, so that workers that got fast tasks help the ones that got
+slow tasks. If a thread cannot be created, its tasks are stolen by the
+others.
+
+Tasks run in no particular order, so each task should write its result to
+a place that depends only on its index.
+
+Checks: if task is NULL.
+        if ntasks >= 0.
+        if nthreads >= 1.
+
+Parameters:
+ntasks: number of tasks.
+nthreads: number of worker threads.
+task: the function that runs a task.
+arg: argument passed to every call of task.
+
+Returns: void */
+void pool_run(int ntasks, int nthreads, Pool_Task_T task, void *arg) {
+    int i;
+    Pool_T pool;
+    Pool_Worker_T *workers;
+    pthread_t *threads;
+    char *started;
+
+    assert(task);
+    assert(ntasks >= 0);
+    assert(nthreads >= 1);
+
+    /* no need for threads */
+    if (nthreads > ntasks) {
+        nthreads = ntasks;
+    }
+    if (nthreads <= 1) {
+        for (i = 0; i < ntasks; i++) {
+            task(arg, 0, i);
+        }
+        return;
+    }
+
+    pool.deques = malloc(nthreads * sizeof(Pool_Deque_T));
+    workers = malloc(nthreads * sizeof(Pool_Worker_T));
+    threads = malloc(nthreads * sizeof(pthread_t));
+    started = malloc(nthreads);
+    assert(pool.deques && workers && threads && started);
+    pool.nthreads = nthreads;
+    pool.task = task;
+    pool.arg = arg;
+
+    /* split the tasks into contiguous ranges */
+    for (i = 0; i < nthreads; i++) {
+        pthread_mutex_init(&pool.deques[i].lock, NULL);
+        pool.deques[i].front = (int)((long)ntasks * i / nthreads);
+        pool.deques[i].back = (int)((long)ntasks * (i + 1) / nthreads);
+        workers[i].pool = &pool;
+        workers[i].id = i;
+    }
+
+    for (i = 1; i < nthreads; i++) {
+        started[i] = !pthread_create(&threads[i], NULL, pool_worker,
+                                     &workers[i]);
+    }
+    pool_worker(&workers[0]);
+    for (i = 1; i < nthreads; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        pthread_mutex_destroy(&pool.deques[i].lock);
+    }
+    free(pool.deques);
+    free(workers);
+    free(threads);
+    free(started);
+    return;
+}
@@ -0,0 +1,54 @@
+/* Thread pool interface: Runs a set of independent tasks on worker threads
+that balance the load with work stealing */
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+
+/* The function that runs a task. arg is the argument given to pool_run,
+worker is the index of the thread that runs the task (0 to nthreads-1) and
+index is the index of the task (0 to ntasks-1). */
+typedef void (*Pool_Task_T)(void *arg, int worker, int index);
+
+
+/* pool_cpu_count
+
+Finds the number of online processors.
+
+Parameters: void
+
+Returns: the number of online processors, or 1 if it is not known. */
+int pool_cpu_count(void);
+
+
+/* pool_run
+
+Runs task(arg, worker, index) for every index from 0 to ntasks-1 using
+nthreads threads, and returns when all tasks have finished. The calling
+thread is worker 0.
+
+Each worker has a deque of task indices that initially holds a contiguous
+range of ntasks/nthreads tasks. A worker takes tasks from the front of its
+own deque. When its deque is empty, it steals the back half of the deque of
+another worker, so that workers that got fast tasks help the ones that got
+slow tasks. If a thread cannot be created, its tasks are stolen by the
+others.
+
+Tasks run in no particular order, so each task should write its result to
+a place that depends only on its index.
+
+Checks: if task is NULL.
+        if ntasks >= 0.
+        if nthreads >= 1.
+
+Parameters:
+ntasks: number of tasks.
+nthreads: number of worker threads.
+task: the function that runs a task.
+arg: argument passed to every call of task.
+
+Returns: void */
+void pool_run(int ntasks, int nthreads, Pool_Task_T task, void *arg);
+
+
+#endif
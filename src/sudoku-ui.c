@@ -6,8 +6,74 @@
 #include <unistd.h>
 #include "sudoku.h"
 
-int has_valid_arguments(int argc, char **argv);
+/* max number of sudokus that are read before they are solved in batch mode */
+#define BATCH_SIZE 1024
+
+/* Struct that holds the command line options.
+
+Fields:
+> mode: what the program does. 0 (solve a sudoku) or the letter of the
+option: 'c', 's', 'b', 'g' or 'h'.
+
+> file: the input file of -b, or NULL for stdin.
+
+> nelts: the argument of -g.
+
+> engine: the solver engine, SUDOKU_ENGINE_DLX if -x is given.
+
+> threads: the argument of -t, or 0 for one thread per processor.
+
+> split: the argument of -p.
+
+> count: the argument of -n, or 0 if -n is not given.
+
+> line: 1 if -l is given.
+
+> complete: SUDOKU_COMPLETE_PERMUTE if -f is given.
+
+> order: the value order of -o, SUDOKU_ORDER_RANDOM if -o is not given.
+
+> deduce: the deductions of -d, SUDOKU_DEDUCE_LOCKED if -d is not given.
+
+> seed: the argument of -r, or the process id.
+
+> size: the argument of -z, or 0 to find the grid size from the input.
+*/
+typedef struct options_s {
+    int mode;
+    char *file;
+    int nelts;
+    int engine;
+    int threads;
+    int split;
+    int count;
+    int line;
+    int complete;
+    int order;
+    int deduce;
+    unsigned long seed;
+    int size;
+} Options_T;
+
+/* the functions that depend on the grid size are compiled once for each
+block size, like the library (see variant.h) */
+#define run_sudoku VARIANT(run_sudoku)
+#define read_and_solve VARIANT(read_and_solve)
+#define solve_batch VARIANT(solve_batch)
+#define generate_batch VARIANT(generate_batch)
+
+int parse_arguments(int argc, char **argv, Options_T *options);
 void print_help(char *exec_name);
+int find_size(FILE *fp, char *line, int size);
+int run_sudoku(Options_T *options, FILE *fp, const char *line);
+void read_and_solve(Solver_T *solver, const char *line);
+void solve_batch(FILE *fp, const char *line, Solver_T *solver);
+void generate_batch(Solver_T *solver, int nelts, int count, int line);
+
+#if BSIZE == 3
+int run_sudoku_b2(Options_T *options, FILE *fp, const char *line);
+int run_sudoku_b4(Options_T *options, FILE *fp, const char *line);
+int run_sudoku_b5(Options_T *options, FILE *fp, const char *line);
 
 /* main
 
@@ -22,83 +88,389 @@ Use:
 3) Read a sudoku from input_file and check its correctness:
 ./sudoku-ui -c < input_file
 
-4) Read a sudoku from input_file and print it in a 9x9 grid:
+4) Read a sudoku from input_file and attempt to solve it using Dancing Links:
+./sudoku-ui -x < input_file
+
+5) Read a sudoku from input_file and print it as a grid:
 ./sudoku-ui -s < input_file
 
-5) Generate a solvable sudoku with 40 non-zero numbers:
+6) Generate a solvable sudoku with 40 non-zero numbers:
 ./sudoku-ui -g 40
 
-6) Generate a solvable sudoku with 40 non-zero numbers and solve it:
+7) Generate a solvable sudoku with 40 non-zero numbers and solve it:
 ./sudoku-ui -g 40 | ./sudoku-ui
 
-7) Display the help:
+8) Read any number of sudokus from stdin or input_file and print one line
+per sudoku with its solution, using one thread per processor:
+./sudoku-ui -b < input_file
+./sudoku-ui -b input_file
+
+9) Same as 8) using 4 threads, or using Dancing Links:
+./sudoku-ui -b input_file -t 4
+./sudoku-ui -b input_file -x
+
+10) Read a hard sudoku from input_file and solve it using one thread per
+processor (or 4 threads) for the branches of the first 2 branch points:
+./sudoku-ui -p 2 < input_file
+./sudoku-ui -p 2 -t 4 < input_file
+
+11) Generate 100000 sudokus with 30 non-zero numbers using one thread per
+processor (or 4 threads) and print them in the grid format separated by empty
+lines, or one per line:
+./sudoku-ui -g 30 -n 100000
+./sudoku-ui -g 30 -n 100000 -t 4 -l
+
+Add -f to start each sudoku from a shuffled pattern instead of a random
+search, which takes constant time:
+./sudoku-ui -g 30 -n 100000 -f
+
+12) Read a 4x4, 9x9, 16x16 or 25x25 sudoku (any mode), or generate one with
+the given size. Values from 10 to 25 are written as letters from A:
+./sudoku-ui < input_file_16x16
+./sudoku-ui -g 150 -z 16
+
+13) Repeat the random choices of a previous run by giving the seed of the
+random number generator (any mode):
+./sudoku-ui -g 40 -r 1234
+./sudoku-ui -b input_file -r 1234
+
+14) Display the help:
 ./sudoku-ui -h
 */
 int main(int argc, char **argv) {
-    Grid_T sudoku, sudoku_solved;
-    int nelts;
+    Options_T options;
+    FILE *fp;
+    char line[SUDOKU_LINE_MAX];
+    int size, ret;
 
-    if (!has_valid_arguments(argc, argv)) {
+    if (!parse_arguments(argc, argv, &options) || options.mode == 'h') {
         print_help(argv[0]);
         return 0;
     }
-    srand(getpid());
-    if (argc == 1) {        /* no arguments */
-        sudoku = sudoku_read();
-        if (!sudoku_format_is_correct(sudoku)) {
-            fprintf(stdout, "Puzzle has incorrect format. Exiting...\n");
-            return 0;
+    fp = stdin;
+    if (options.file) {
+        fp = fopen(options.file, "r");
+        if (!fp) {
+            fprintf(stderr, "Cannot open %s\n", options.file);
+            return 1;
         }
-        sudoku_print(sudoku);
-        if (!sudoku_is_correct(sudoku, 0)) {
-            sudoku_print_errors(sudoku);
-            return 0;
-        }
-        sudoku_solved = sudoku_solve(sudoku);
-        if (!sudoku_is_correct(sudoku_solved, 1)) {
-            fprintf(stdout, "Puzzle has no solutions\n");
-            return 0;
-        }
-        if (sudoku_has_unique_choice_solution(sudoku_solved)) {
-            fprintf(stdout, "Puzzle has a unique solution:\n");
+    }
+
+    /* the generator has no input, the other modes read the first line of
+    the input to find the grid size */
+    line[0] = '\0';
+    size = options.size ? options.size : SIZE;
+    if (options.mode != 'g') {
+        size = find_size(fp, line, options.size);
+    }
+
+    if (size == 4) {
+        ret = run_sudoku_b2(&options, fp, line);
+    }
+    else if (size == 16) {
+        ret = run_sudoku_b4(&options, fp, line);
+    }
+    else if (size == 25) {
+        ret = run_sudoku_b5(&options, fp, line);
+    }
+    else {
+        ret = run_sudoku(&options, fp, line);
+    }
+    if (options.file) {
+        fclose(fp);
+    }
+    return ret;
+}
+
+
+/* find_size
+
+Reads the first non-blank line of the given stream and finds the size of the
+grids from its number of cells: SIZE cells for a line of the multi-line format
+and SIZE*SIZE cells for the single line format (see sudoku_read_file). A line
+of 16 cells is a line of a 16x16 grid if its cells are separated by spaces,
+and a 4x4 grid in the single line format otherwise.
+
+Parameters:
+fp: the input stream
+line: buffer of SUDOKU_LINE_MAX chars that will hold the line, or an empty
+string if the end of the stream is reached
+size: the argument of -z, or 0
+
+Returns: the grid size, 4, 9, 16 or 25. If size is not 0 it is returned, and
+if the size cannot be found it is 9, so that the input is reported as a 9x9
+grid with the incorrect format. */
+int find_size(FILE *fp, char *line, int size) {
+    int count, spaces;
+    char *c;
+
+    /* skip blank lines */
+    do {
+        if (!fgets(line, SUDOKU_LINE_MAX, fp)) {
+            line[0] = '\0';
+            break;
         }
-        else {
-            fprintf(stdout, "Puzzle has a solution (multiple solutions may exist):\n");
+        for (c = line, count = spaces = 0; *c; c++) {
+            if (*c == ' ') {
+                spaces++;
+            }
+            else if (*c != '\n' && *c != '\r') {
+                count++;
+            }
         }
-        sudoku_print(sudoku_solved);
+    } while (!count);
+
+    if (size) {
+        return size;
+    }
+    if (count == 4 || count == 25 || count == 625) {
+        return count == 4 ? 4 : 25;
+    }
+    if (count == 256 || (count == 16 && spaces)) {
+        return 16;
     }
-    else if (argc == 3) {   /* argument -g <nelts> */
-        nelts = atoi(argv[2]);
-        sudoku = sudoku_generate(nelts);
-        if (sudoku_has_unique_choice_solution(sudoku)) {
+    if (count == 16) {
+        return 4;
+    }
+    return 9;
+}
+
+#endif
+
+
+/* run_sudoku
+
+Does what the given options ask for with a grid of size SIZE. This function
+is compiled for each block size and main calls the one for the size of the
+input.
+
+Parameters:
+options: the command line options
+fp: the input stream of -b, or stdin
+line: the first line of the input (see find_size), or an empty string for -g
+
+Returns: the exit status of the program */
+int run_sudoku(Options_T *options, FILE *fp, const char *line) {
+    Grid_T sudoku;
+    Solver_T solver;
+
+    sudoku_solver_init(&solver);
+    sudoku_solver_seed(&solver, options->seed);
+    solver.engine = options->engine;
+    solver.threads = options->threads;
+    solver.split = options->split;
+    solver.complete = options->complete;
+    solver.order = options->order;
+    solver.deduce = options->deduce;
+    if (!options->mode) {        /* no arguments, -x, or -p */
+        read_and_solve(&solver, line);
+    }
+    else if (options->mode == 'b') {   /* -b [file] */
+        solve_batch(fp, line, &solver);
+    }
+    else if (options->mode == 'g' && options->count) {   /* -g <nelts> -n */
+        generate_batch(&solver, options->nelts, options->count,
+                       options->line);
+    }
+    else if (options->mode == 'g') {   /* -g <nelts> */
+        if (sudoku_generate_with_p(&solver, options->nelts, &sudoku)) {
             fprintf(stderr, "Generating a puzzle that has a unique solution...\n");
         }
         else {
             fprintf(stderr, "Generating a puzzle that may have multiple solutions...\n");
         }
-        sudoku_print(sudoku);
+        if (options->line) {
+            sudoku_print_line_p(&sudoku);
+        }
+        else {
+            sudoku_print_p(&sudoku);
+        }
     }
-    else if (argc == 2) {   /* argument -c, -s */
-        if (!strcmp(argv[1], "-h")) { /* -h */
-            print_help(argv[0]);
+    else {   /* -c, -s */
+        if (sudoku_read_lines(fp, line, &sudoku) != 1) {
+            fprintf(stdout, "Puzzle has incorrect format. Exiting...\n");
             return 0;
         }
-        sudoku = sudoku_read();
-        sudoku_print(sudoku);
-        if (!strcmp(argv[1], "-s")) { /* -s */
+        sudoku_print_p(&sudoku);
+        if (options->mode == 's') {
             return 0;
         }
-        if (sudoku_is_correct(sudoku, 1)) {
+        if (sudoku_is_correct_p(&sudoku, 1)) {
             fprintf(stderr, "No issues found\n");
         } else {
-            sudoku_print_errors(sudoku);
-            sudoku_print_empty(sudoku);
+            sudoku_print_errors_p(&sudoku);
+            sudoku_print_empty_p(&sudoku);
         }
     }
     return 0;
 }
 
 
+/* read_and_solve
+
+Reads a sudoku from stdin, prints it and attempts to solve it using the given
+solver. Prints the solution or the errors that were found.
+
+Parameters:
+solver: the solver options
+line: the first line of the sudoku (see find_size)
+
+Returns: void */
+void read_and_solve(Solver_T *solver, const char *line) {
+    Grid_T sudoku;
+    Result_T result;
+
+    if (sudoku_read_lines(stdin, line, &sudoku) != 1 ||
+        !sudoku_format_is_correct_p(&sudoku)) {
+        fprintf(stdout, "Puzzle has incorrect format. Exiting...\n");
+        return;
+    }
+    sudoku_print_p(&sudoku);
+    sudoku_solve_result_p(solver, &sudoku, &result);
+    if (result.status == SUDOKU_INVALID) {
+        sudoku_print_errors_p(&sudoku);
+        return;
+    }
+    if (result.status != SUDOKU_SOLVED) {
+        fprintf(stdout, "Puzzle has no solutions\n");
+        return;
+    }
+    if (result.unique) {
+        fprintf(stdout, "Puzzle has a unique solution:\n");
+    }
+    else {
+        fprintf(stdout, "Puzzle has a solution (multiple solutions may exist):\n");
+    }
+    sudoku_print_p(&result.solution);
+    return;
+}
+
+
+/* solve_batch
+
+Reads sudokus from the given stream until its end and solves them using the
+given solver. Sudokus are read and solved BATCH_SIZE at a time. For each
+sudoku, one line is written to stdout, in the same order as the input:
+- the solution in the single line format of sudoku_print_line_p, or
+- "Puzzle has incorrect format", or
+- "Puzzle violates sudoku rules", or
+- "Puzzle has no solutions".
+
+Parameters:
+fp: the input stream
+line: the first line of the first sudoku (see find_size), or an empty string
+if there is no sudoku
+solver: the solver options
+
+Returns: void */
+void solve_batch(FILE *fp, const char *line, Solver_T *solver) {
+    Grid_T *sudokus;
+    Result_T *results;
+    int i, n, k, ret, read[BATCH_SIZE];
+
+    sudokus = malloc(BATCH_SIZE * sizeof(Grid_T));
+    results = malloc(BATCH_SIZE * sizeof(Result_T));
+    if (!sudokus || !results) {
+        fprintf(stderr, "Out of memory\n");
+        free(sudokus);
+        free(results);
+        return;
+    }
+
+    /* write the output in large blocks */
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+    do {
+
+        /* read[i] is 1 if the i-th sudoku has the correct format. Only
+        those are stored in sudokus */
+        for (n = 0, k = 0; n < BATCH_SIZE; n++) {
+            if (*line) {
+                ret = sudoku_read_lines(fp, line, &sudokus[k]);
+                line = "";
+            }
+            else {
+                ret = sudoku_read_file(fp, &sudokus[k]);
+            }
+            if (!ret) {
+                break;
+            }
+            read[n] = (ret == 1);
+            k += read[n];
+        }
+        sudoku_solve_batch_results(solver, sudokus, results, k);
+
+        for (i = 0, k = 0; i < n; i++) {
+            if (!read[i]) {
+                fputs("Puzzle has incorrect format\n", stdout);
+            }
+            else if (results[k].status == SUDOKU_INVALID) {
+                fputs("Puzzle violates sudoku rules\n", stdout);
+            }
+            else if (results[k].status != SUDOKU_SOLVED) {
+                fputs("Puzzle has no solutions\n", stdout);
+            }
+            else {
+                sudoku_print_line_p(&results[k].solution);
+            }
+            k += read[i];
+        }
+    } while (n == BATCH_SIZE);
+    fflush(stdout);
+    free(results);
+    free(sudokus);
+    return;
+}
+
+
+/* generate_batch
+
+Generates count sudokus with nelts non-zero cells using the given solver and
+writes them to stdout, BATCH_SIZE at a time. Sudokus are written in the
+format of sudoku_print_p separated by an empty line, or in the single line
+format of sudoku_print_line_p.
+
+Parameters:
+solver: the solver options
+nelts: number of non-zero cells
+count: number of sudokus
+line: 1 for the single line format, 0 otherwise
+
+Returns: void */
+void generate_batch(Solver_T *solver, int nelts, int count, int line) {
+    Grid_T *sudokus;
+    int i, n, done;
+
+    sudokus = malloc(BATCH_SIZE * sizeof(Grid_T));
+    if (!sudokus) {
+        fprintf(stderr, "Out of memory\n");
+        return;
+    }
+
+    /* write the output in large blocks */
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+    for (done = 0; done < count; done += n) {
+        n = count - done < BATCH_SIZE ? count - done : BATCH_SIZE;
+        sudoku_generate_batch(solver, nelts, sudokus, n);
+        for (i = 0; i < n; i++) {
+            if (line) {
+                sudoku_print_line_p(&sudokus[i]);
+                continue;
+            }
+            if (done + i) {
+                fputc('\n', stdout);
+            }
+            sudoku_print_p(&sudokus[i]);
+        }
+    }
+    fflush(stdout);
+    free(sudokus);
+    return;
+}
+
+
+#if BSIZE == 3
+
+
 /* print_help
 
 Prints the help message
@@ -107,55 +479,217 @@ Parameters:
 exec_name: the executable name */
 void print_help(char *exec_name) {
     fprintf(stderr, "Usage: %s [option]\n", exec_name);
-    fprintf(stderr, "Options (only one option can be used at a time):\n");
+    fprintf(stderr, "Options (only -x, -o, -d and -t can be combined with");
+    fprintf(stderr, " -b, -o, -d and -t with -p, -n, -l, -f and -t with -g,");
+    fprintf(stderr, " -r and -z with any option):\n");
     fprintf(stderr, "  -h\t\tDisplay this information\n");
     fprintf(stderr, "  -c\t\tReads a sudoku puzzle from stdin");
     fprintf(stderr, " and checks its correctness\n");
     fprintf(stderr, "  -s\t\tReads a sudoku puzzle from stdin");
     fprintf(stderr, " and prints it to stdout\n");
+    fprintf(stderr, "  -x\t\tReads a sudoku puzzle from stdin");
+    fprintf(stderr, " and solves it using Dancing Links\n");
+    fprintf(stderr, "  -b [file]\tReads sudoku puzzles from stdin or file");
+    fprintf(stderr, " and prints one solution per line\n");
+    fprintf(stderr, "  -p <levels>\tReads a sudoku puzzle from stdin");
+    fprintf(stderr, " and solves the branches of the first <levels>");
+    fprintf(stderr, " branch points in parallel\n");
+    fprintf(stderr, "  -o <order>\tTries the values of a cell in");
+    fprintf(stderr, " <order> when solving: random, lcv (least");
+    fprintf(stderr, " constraining first) or units (fewest places in a unit");
+    fprintf(stderr, " first) (default: random)\n");
+    fprintf(stderr, "  -d <set>\tRemoves choices between branch points");
+    fprintf(stderr, " with the deductions of <set> when solving: none,");
+    fprintf(stderr, " locked (locked candidates) or all (also naked and");
+    fprintf(stderr, " hidden pairs and triples and X-Wings) (default:");
+    fprintf(stderr, " locked)\n");
+    fprintf(stderr, "  -t <number>\tSolves or generates the puzzles of -b,");
+    fprintf(stderr, " -p or -n using <number> threads (default: one per");
+    fprintf(stderr, " processor)\n");
+    fprintf(stderr, "  -r <number>\tSeeds the random choices with <number>");
+    fprintf(stderr, " (default: the process id)\n");
+    fprintf(stderr, "  -z <size>\tUses <size>x<size> grids, 4, 9, 16 or 25");
+    fprintf(stderr, " (default: found from the input, 9 with -g)\n");
     fprintf(stderr, "  -g <number>\tGenerates a sudoku puzzle");
     fprintf(stderr, " with approximately <number> completed cells\n");
+    fprintf(stderr, "  -n <count>\tGenerates <count> puzzles with -g\n");
+    fprintf(stderr, "  -l\t\tPrints the puzzles of -g one per line\n");
+    fprintf(stderr, "  -f\t\tGenerates the puzzles of -g from shuffled");
+    fprintf(stderr, " complete grids\n");
 }
 
 
-/* has_valid_arguments
+/* parse_arguments
 
 Checks that the command line arguments indicated by the parameters argc and
-argv have the expected format and prints a help message. Only
-the following arguments are considered valid:
+argv have the expected format and stores them in options. Only the following
+arguments are considered valid:
 -h
--g <nelts>  (1 <= nelts <= 81)
+-g <nelts> [-n <count>] [-t <threads>] [-l] [-f]  (1 <= nelts <= size*size,
+                                                   count >= 1, in any order)
 -c
 -s
+-x
+-b [file] [-x] [-o <order>] [-d <set>] [-t <threads>]  (threads >= 1, in
+                                                        any order)
+-p <levels> [-o <order>] [-d <set>] [-t <threads>]  (1 <= levels <=
+                                                    SUDOKU_SPLIT_MAX)
+-o <order> [-d <set>]  (order is random, lcv or units, set is none, locked
+                        or all)
+-r <seed> combined with any of the above
+-z <size> combined with any of the above  (size is 4, 9, 16 or 25)
 
-Any combination of the above arguments is considered invalid.
+Any other combination of the above arguments is considered invalid.
 
 Parameters:
 argc: number of command line arguments
 argv: the command line arguments
+options: a pointer to an Options_T type that will hold the options
 
 Returns: 1 if the arguments are valid, 0 otherwise. */
-int has_valid_arguments(int argc, char **argv) {
-    int valid = 1;
+int parse_arguments(int argc, char **argv, Options_T *options) {
+    int i;
+    char *end;
 
-    if (argc > 3) {
-        valid = 0;
-    }
-    else if (argc == 3) {
-        if (strcmp(argv[1], "-g")) {
-            valid = 0;
+    options->mode = 0;
+    options->file = NULL;
+    options->nelts = 0;
+    options->engine = SUDOKU_ENGINE_BACKTRACK;
+    options->threads = 0;
+    options->split = 0;
+    options->count = 0;
+    options->line = 0;
+    options->complete = SUDOKU_COMPLETE_SEARCH;
+    options->order = SUDOKU_ORDER_RANDOM;
+    options->deduce = SUDOKU_DEDUCE_LOCKED;
+    options->seed = (unsigned long)getpid();
+    options->size = 0;
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-x")) {
+            options->engine = SUDOKU_ENGINE_DLX;
         }
-        if (!atoi(argv[2])) {
-            valid = 0;
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            options->seed = strtoul(argv[++i], &end, 10);
+            if (!argv[i][0] || *end != '\0') {
+                return 0;
+            }
         }
-    }
-    else if (argc == 2) {
-        if (strcmp(argv[1], "-c") && strcmp(argv[1], "-s")) {
-            valid = 0;
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+            options->split = atoi(argv[++i]);
+            if (options->split < 1 || options->split > SUDOKU_SPLIT_MAX) {
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            options->count = atoi(argv[++i]);
+            if (options->count < 1) {
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "-z") && i + 1 < argc) {
+            options->size = atoi(argv[++i]);
+            if (options->size != 4 && options->size != 9 &&
+                options->size != 16 && options->size != 25) {
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "-l")) {
+            options->line = 1;
+        }
+        else if (!strcmp(argv[i], "-f")) {
+            options->complete = SUDOKU_COMPLETE_PERMUTE;
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            i++;
+            if (!strcmp(argv[i], "lcv")) {
+                options->order = SUDOKU_ORDER_LCV;
+            }
+            else if (!strcmp(argv[i], "units")) {
+                options->order = SUDOKU_ORDER_UNITS;
+            }
+            else if (strcmp(argv[i], "random")) {
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            i++;
+            if (!strcmp(argv[i], "none")) {
+                options->deduce = 0;
+            }
+            else if (!strcmp(argv[i], "all")) {
+                options->deduce = SUDOKU_DEDUCE_ALL;
+            }
+            else if (strcmp(argv[i], "locked")) {
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            options->threads = atoi(argv[++i]);
+            if (options->threads < 1) {
+                return 0;
+            }
+        }
+
+        /* only one of the remaining options can be used */
+        else if (options->mode) {
+            return 0;
+        }
+        else if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+            options->mode = 'g';
+            options->nelts = atoi(argv[++i]);
+            if (options->nelts < 1) {
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "-b")) {
+            options->mode = 'b';
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                options->file = argv[++i];
+            }
         }
-        else if (!strcmp(argv[1], "-h")) {
-            valid = 0;
+        else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "-s") ||
+                 !strcmp(argv[i], "-h")) {
+            options->mode = argv[i][1];
         }
+        else {
+            return 0;
+        }
+    }
+
+    /* -x is used when solving, -p when solving a single sudoku without -x,
+    -o and -d when solving without -x, -n, -l and -f when generating, -t in
+    batch mode or with -p or -g */
+    if (options->engine == SUDOKU_ENGINE_DLX && options->mode &&
+        options->mode != 'b') {
+        return 0;
+    }
+    if (options->split &&
+        (options->mode || options->engine == SUDOKU_ENGINE_DLX)) {
+        return 0;
+    }
+    if ((options->order != SUDOKU_ORDER_RANDOM ||
+         options->deduce != SUDOKU_DEDUCE_LOCKED) &&
+        ((options->mode && options->mode != 'b') ||
+         options->engine == SUDOKU_ENGINE_DLX)) {
+        return 0;
+    }
+    if ((options->count || options->line ||
+         options->complete == SUDOKU_COMPLETE_PERMUTE) &&
+        options->mode != 'g') {
+        return 0;
+    }
+    if (options->threads && options->mode != 'b' && options->mode != 'g' &&
+        !options->split) {
+        return 0;
     }
-    return valid;
+
+    /* the grid of -g is 9x9 unless -z is given */
+    if (options->mode == 'g' &&
+        options->nelts > (options->size ? options->size : SIZE) *
+                         (options->size ? options->size : SIZE)) {
+        return 0;
+    }
+    return 1;
 }
+
+#endif
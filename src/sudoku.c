@@ -2,25 +2,289 @@
 
 Uses lower level functions declared in grid.h */
 
+/* for clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdio.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <string.h>
+#include <time.h>
 #include "sudoku.h"
-
-static Grid_T sudoku_generate_complete(void);
+#include "tables.h"
+#include "dlx.h"
+#include "pool.h"
+
+/* max number of trail entries. Every entry removes at least one choice from
+a cell, so a grid cannot have more entries than choices */
+#define TRAIL_SIZE (SIZE * SIZE * SIZE)
+
+/* the cell at position pos of a line: of row line if cols is 0, else of
+column line */
+#define LINE_CELL(cols, line, pos) \
+    ((cols) ? (pos) * SIZE + (line) : (line) * SIZE + (pos))
+
+/* a deduction that found nothing n times in a row is skipped the next
+cost * 2^(n-1) times, at most DEDUCE_SKIP_MAX times (see sudoku_deduce) */
+#define DEDUCE_SKIP_MAX 64
+
+/* max size of the naked and hidden subsets */
+#define DEDUCE_SUBSET_MAX 3
+
+/* the deadline of a solve is only read when the number of nodes is a
+multiple of DEADLINE_NODES, a power of 2, to not read the clock at every
+node */
+#define DEADLINE_NODES 256
+
+/* STATS_ADD adds n to a field of the statistics of a solver and STATS_DEPTH
+raises their max_depth to d, if the solver has statistics (see Stats_T).
+Both do nothing unless SUDOKU_STATS is defined. */
+#ifdef SUDOKU_STATS
+#define STATS_ADD(solver, field, n) \
+    do { \
+        if ((solver)->stats) { \
+            (solver)->stats->field += (n); \
+        } \
+    } while (0)
+#define STATS_DEPTH(solver, d) \
+    do { \
+        if ((solver)->stats && (solver)->stats->max_depth < (d)) { \
+            (solver)->stats->max_depth = (d); \
+        } \
+    } while (0)
+#else
+#define STATS_ADD(solver, field, n) do { } while (0)
+#define STATS_DEPTH(solver, d) do { } while (0)
+#endif
+
+/* rotates the 32-bit word x left by k bits */
+#define ROTL32(x, k) (((x) << (k) | (x) >> (32 - (k))) & 0xffffffffUL)
+
+
+/* Struct that records the changes made to a grid during a search, so that
+they can be undone when backtracking.
+
+Fields:
+> entries[TRAIL_SIZE]: the changes, from oldest to newest. cell is the linear
+index row * SIZE + col of the changed cell, val is the value that was placed
+in the cell or 0 if only choices were removed, and removed has the choices
+that were removed from the cell.
+
+> count: the number of entries.
+
+> branches[SIZE*SIZE]: the branch points of the search, from oldest to newest.
+mark is the number of entries before the branch, cell and val are the cell
+and the value that was tried.
+
+> depth: the number of branch points.
+*/
+typedef struct trail_s {
+    struct {
+        int cell;
+        int val;
+        Choices_T removed;
+    } entries[TRAIL_SIZE];
+    int count;
+    struct {
+        int mark;
+        int cell;
+        int val;
+    } branches[SIZE * SIZE];
+    int depth;
+} Trail_T;
+
+
+/* Struct that holds the subtasks of a search that is split among threads.
+
+Fields:
+> grids: the grids of the subtasks, in the order that the sequential search
+would visit them. Each subtask solves its grid in place.
+
+> count: the number of subtasks.
+
+> size: the number of grids that grids has room for. It is doubled when a
+subtask does not fit.
+
+> failed: 1 if grids could not be grown, so some subtasks are missing.
+
+> solved: solved[i] is set to 1 when the i-th subtask finds a solution.
+
+> solvers: a copy of the solver for each worker thread.
+
+> seed: the i-th subtask is solved with seed + i.
+
+> found: set to 1 when a subtask finds a solution. The solvers of the workers
+point to it, so that the other subtasks stop.
+
+> cancel: the cancel flag of the solver that started the search.
+*/
+typedef struct split_s {
+    Grid_T *grids;
+    int count;
+    int size;
+    int failed;
+    int *solved;
+    Solver_T *solvers;
+    unsigned long seed;
+    volatile int found;
+    volatile int *cancel;
+} Split_T;
+
+
+/* Struct that is passed to sudoku_solve_task and sudoku_generate_task.
+
+Fields:
+> solvers: a copy of the solver for each worker thread, so that each thread
+has its own random number generator.
+
+> nthreads: the number of worker threads.
+
+> seed: the i-th sudoku is solved or generated with seed + i.
+
+> grids, solved: the arguments of sudoku_solve_batch.
+
+> results: the argument of sudoku_solve_batch_results, or NULL.
+
+> nelts: the argument of sudoku_generate_batch. The sudokus are generated in
+solved.
+*/
+typedef struct batch_s {
+    Solver_T *solvers;
+    int nthreads;
+    unsigned long seed;
+    const Grid_T *grids;
+    Grid_T *solved;
+    Result_T *results;
+    int nelts;
+} Batch_T;
+
+static Grid_T sudoku_generate_complete(Solver_T *solver);
+static void sudoku_shuffle(Solver_T *solver, int *perm, int n);
+static void sudoku_permute_lines(Solver_T *solver, int *lines);
+static Grid_T sudoku_permute_complete(Solver_T *solver);
+static int sudoku_char_value(int c);
+static char sudoku_value_char(int val);
+static int sudoku_parse_line(const char *line, int *vals, int max);
 static void sudoku_init_choices(Grid_T *grid);
-static void sudoku_set_choice(Grid_T *grid, int row, int col, int val);
-static int sudoku_try_next(Grid_T grid, int *row, int *col);
-static int sudoku_errors_rules(Grid_T grid, int show, int index, int type);
-static int sudoku_errors_empty(Grid_T grid, int show);
+static void sudoku_trail_push(Trail_T *trail, int cell, int val,
+                              Choices_T removed);
+static void sudoku_trail_undo(Grid_T *grid, Trail_T *trail, int mark);
+static void sudoku_remove_choice(Grid_T *grid, Trail_T *trail, int cell,
+                                 int val);
+static void sudoku_set_choice(Grid_T *grid, Trail_T *trail, int row, int col,
+                              int val);
+static int sudoku_random(Solver_T *solver, int n);
+static int sudoku_flag_read(volatile int *flag);
+static void sudoku_flag_set(volatile int *flag);
+static double sudoku_now(void);
+static void sudoku_limit_start(Solver_T *solver);
+static int sudoku_aborted(Solver_T *solver);
+static int sudoku_dlx_aborted(void *solver);
+static int sudoku_order_value(Solver_T *solver, const Grid_T *grid, int cell);
+static int sudoku_try_next(Solver_T *solver, const Grid_T *grid, int *row,
+                           int *col);
+static int sudoku_errors_rules(const Grid_T *grid, int show, int index, int type);
+static int sudoku_errors_empty(const Grid_T *grid, int show);
+static int sudoku_errors_masks(const Grid_T *grid, int allow_empty);
+static int sudoku_remove_choices(Grid_T *grid, Trail_T *trail, int cell,
+                                 Choices_T removed);
+static int sudoku_next_subset(int *index, int n, int count);
+static int sudoku_deduce_locked(Grid_T *grid, Trail_T *trail);
+static int sudoku_deduce_subsets(Grid_T *grid, Trail_T *trail, int n);
+static int sudoku_deduce_xwing(Grid_T *grid, Trail_T *trail);
+static int sudoku_deduce(Solver_T *solver, Grid_T *grid, Trail_T *trail);
+static int sudoku_propagate(Solver_T *solver, Grid_T *grid, Trail_T *trail);
+static int sudoku_check_rules(Grid_T *grid);
+static int sudoku_solve_grid(Solver_T *solver, Grid_T *grid, int depth);
+static int sudoku_solve_dlx(Solver_T *solver, Grid_T *grid);
+static int sudoku_solve_iterative(Solver_T *solver, Grid_T *grid);
+static int sudoku_solve_engine(Solver_T *solver, Grid_T *grid);
+static unsigned long sudoku_luby(unsigned long i);
+static int sudoku_solve_restarts(Solver_T *solver, Grid_T *grid);
+static int sudoku_solve_status(Solver_T *solver, const Grid_T *grid,
+                               Grid_T *solved);
+static void sudoku_stats_fork(Solver_T *solver, Solver_T *copies, int n);
+static void sudoku_stats_join(Solver_T *solver, Solver_T *copies, int n,
+                              int seconds);
+static void sudoku_batch_init(Solver_T *solver, Batch_T *batch, int n);
+static void sudoku_batch_done(Solver_T *solver, Batch_T *batch);
+static void sudoku_solve_task(void *arg, int worker, int index);
+static void sudoku_generate_task(void *arg, int worker, int index);
+static void sudoku_split(Solver_T *solver, Grid_T *grid, int depth,
+                         Split_T *split);
+static void sudoku_split_task(void *arg, int worker, int index);
+static int sudoku_solve_split(Solver_T *solver, Grid_T *grid);
+static int sudoku_count_grid(Solver_T *solver, Grid_T *grid, Trail_T *trail,
+                             int limit);
+
+/* the SUDOKU_DEDUCE_* deductions in the order that they are tried, and their
+relative costs (see sudoku_deduce) */
+static const int sudoku_deductions[SUDOKU_DEDUCE_COUNT] = {
+    SUDOKU_DEDUCE_LOCKED, SUDOKU_DEDUCE_PAIRS, SUDOKU_DEDUCE_XWING,
+    SUDOKU_DEDUCE_TRIPLES
+};
+static const int sudoku_deduction_costs[SUDOKU_DEDUCE_COUNT] = {
+    1, 2, 3, 6
+};
+
+
+/* sudoku_char_value
+
+Converts the char of a cell to its value. A value from 1 to 9 is written as a
+digit and a value from 10 to SIZE as a letter from A (upper or lower case).
+An empty cell is written as a dot char or 0.
+
+Parameters:
+c: the char of a cell.
+
+Returns: the value of the cell (0 for an empty cell), or -1 if c is not a
+valid cell for a SIZExSIZE grid. */
+static int sudoku_char_value(int c) {
+    int val;
+
+    if (c == '.') {
+        return 0;
+    }
+    if (c >= '0' && c <= '9') {
+        val = c - '0';
+    }
+    else if (c >= 'A' && c <= 'Z') {
+        val = c - 'A' + 10;
+    }
+    else if (c >= 'a' && c <= 'z') {
+        val = c - 'a' + 10;
+    }
+    else {
+        return -1;
+    }
+    return val <= SIZE ? val : -1;
+}
+
+
+/* sudoku_value_char
+
+Converts the value of a cell to its char, see sudoku_char_value.
+
+Parameters:
+val: the value of a cell, from 0 to SIZE.
+
+Returns: the char of the cell. A dot char for an empty cell. */
+static char sudoku_value_char(int val) {
+    if (!val) {
+        return '.';
+    }
+    return val < 10 ? '0' + val : 'A' + val - 10;
+}
 
 
 /* sudoku_read: Reads a sudoku from stdin.
 
-The accepted format is 9 numbers per line. After each number there is a space
-char. Empty cells are denoted by a dot char. After the last cell in each line
-there is a LF char. Throws assertion error if format is not met.
+The accepted format is SIZE cells per line. After each cell there is a space
+char. A cell is a number from 1 to 9 or a letter from A for the values from
+10 to SIZE (see sudoku_char_value). Empty cells are denoted by a dot char.
+After the last cell in each line there is a LF char. Throws assertion error if
+format is not met.
 
 Example:
 1 . . . . 7 . 9 .
@@ -40,6 +304,7 @@ Grid_T sudoku_read(void) {
     int i, j, val;
     Grid_T sudoku;
 
+    grid_init(&sudoku);
     for (i = 0; i < SIZE; i++) {
         if (i != 0) {
             val = getchar();
@@ -55,37 +320,170 @@ Grid_T sudoku_read(void) {
                 val = getchar();
             }
 
-            /* replace '.' with 0 */
-            if (val == '.') {
-                val = '0';
-            }
-
-            /* must be a digit between 0 and 9 */
-            assert (val >= 48 && val <= 57);
+            /* must be a dot, 0 or a value between 1 and SIZE */
+            val = sudoku_char_value(val);
+            assert(val >= 0);
 
-            grid_update_value(&sudoku, i, j, val - '0');
+            grid_update_value(&sudoku, i, j, val);
         }
     }
-    grid_reset_unique(&sudoku);
-    grid_reset_rulesok(&sudoku);
-    grid_clear_initialized(&sudoku);
     return sudoku;
 }
 
 
-/* sudoku_format_is_correct
+/* sudoku_parse_line
+
+Reads the cells of a line. A cell is a value from 1 to SIZE (see
+sudoku_char_value), or a dot char or 0 for an empty cell. Spaces and the line
+terminator are skipped.
+
+Checks: if line is NULL.
+        if vals is NULL.
+
+Parameters:
+line: a null terminated string.
+vals: array that will hold the values of the cells.
+max: max number of cells that fit in vals.
+
+Returns: the number of cells, or -1 if the line has an invalid char or more
+than max cells. */
+static int sudoku_parse_line(const char *line, int *vals, int max) {
+    int count;
+
+    assert(line);
+    assert(vals);
+    for (count = 0; *line; line++) {
+        if (*line == ' ' || *line == '\n' || *line == '\r') {
+            continue;
+        }
+        if (count == max) {
+            return -1;
+        }
+        vals[count] = sudoku_char_value(*line);
+        if (vals[count++] < 0) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+
+/* sudoku_read_file
+
+Reads the next sudoku from the given stream. Blank lines before the sudoku
+are skipped. Two formats are accepted:
+
+- the format of sudoku_read: SIZE lines of SIZE cells each.
+- a single line of SIZE*SIZE cells.
+
+In both formats a cell is a value from 1 to SIZE (see sudoku_char_value), or
+a dot char or 0 for an empty cell. Cells may be separated by spaces.
+
+Example of the single line format:
+1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..
+
+Checks: if fp is NULL.
+        if grid is NULL.
+
+Parameters:
+fp: the input stream.
+grid: a pointer to a Grid_T type that will hold the sudoku.
+
+Returns: 1 if a sudoku was read, 0 if the end of the stream was reached
+before a sudoku was found, -1 if the sudoku does not have the correct format. */
+int sudoku_read_file(FILE *fp, Grid_T *grid) {
+    int vals[SIZE * SIZE];
+    char line[SUDOKU_LINE_MAX];
+
+    assert(fp);
+    assert(grid);
+
+    /* skip blank lines */
+    do {
+        if (!fgets(line, SUDOKU_LINE_MAX, fp)) {
+            return 0;
+        }
+    } while (!sudoku_parse_line(line, vals, SIZE * SIZE));
+
+    return sudoku_read_lines(fp, line, grid);
+}
+
+
+/* sudoku_read_lines
+
+Same as sudoku_read_file for a sudoku whose first line has already been read
+from the given stream with fgets, for example to find the size of the grid.
+The remaining lines of the multi-line format are read from the stream.
+
+Checks: if fp is NULL.
+        if line is NULL.
+        if grid is NULL.
+
+Parameters:
+fp: the input stream.
+line: the first non-blank line of the sudoku, as read by fgets with a buffer
+of SUDOKU_LINE_MAX chars.
+grid: a pointer to a Grid_T type that will hold the sudoku.
+
+Returns: 1 if a sudoku was read, -1 if the sudoku does not have the correct
+format. */
+int sudoku_read_lines(FILE *fp, const char *line, Grid_T *grid) {
+    int i, j, count, vals[SIZE * SIZE];
+    char next[SUDOKU_LINE_MAX];
+
+    assert(fp);
+    assert(line);
+    assert(grid);
+
+    /* a line that does not fit in the buffer is invalid */
+    if (!strchr(line, '\n') && !feof(fp)) {
+        do {
+            i = fgetc(fp);
+        } while (i != EOF && i != '\n');
+        return -1;
+    }
+    count = sudoku_parse_line(line, vals, SIZE * SIZE);
+
+    /* read the remaining lines of the multi-line format */
+    if (count == SIZE) {
+        for (i = 1; i < SIZE; i++) {
+            if (!fgets(next, SUDOKU_LINE_MAX, fp) ||
+                sudoku_parse_line(next, vals + i * SIZE, SIZE) != SIZE) {
+                return -1;
+            }
+        }
+    }
+    else if (count != SIZE * SIZE) {
+        return -1;
+    }
+
+    grid_init(grid);
+    for (i = 0; i < SIZE; i++) {
+        for (j = 0; j < SIZE; j++) {
+            grid_update_value(grid, i, j, vals[i * SIZE + j]);
+        }
+    }
+    return 1;
+}
+
+
+/* sudoku_format_is_correct_p
 
 Indicates whether the given sudoku has the correct format.
 
+Checks: if grid is NULL.
+
 Parameters:
-grid: a Grid_T type.
+grid: pointer to a constant Grid_T type.
 
 Returns: 1 if the format is OK, 0 otherwise */
-int sudoku_format_is_correct(Grid_T grid) {
+int sudoku_format_is_correct_p(const Grid_T *grid) {
     int i, j, val;
+
+    assert(grid);
     for (i = 0; i < SIZE; i++) {
         for (j = 0; j < SIZE; j++) {
-            val = grid_read_value(grid, i, j);
+            val = grid_read_value_p(grid, i, j);
             if (val < 0 || val > SIZE) {
                 return 0;
             }
@@ -95,35 +493,99 @@ int sudoku_format_is_correct(Grid_T grid) {
 }
 
 
-/* sudoku_print:
+/* sudoku_format_is_correct
+
+Indicates whether the given sudoku has the correct format. Same as
+sudoku_format_is_correct_p() for a grid passed by value.
+
+Parameters:
+grid: a Grid_T type.
+
+Returns: 1 if the format is OK, 0 otherwise */
+int sudoku_format_is_correct(Grid_T grid) {
+    return sudoku_format_is_correct_p(&grid);
+}
+
+
+/* sudoku_print_p:
 
 Writes the given sudoku to stdout.
 
-The format is 9 numbers per line. After each number there is a space char.
-Empty cells are denoted by a dot char. After the last cell in each line there
-is a LF char.
+The format is SIZE cells per line (see sudoku_read). After each cell there is
+a space char. Empty cells are denoted by a dot char. After the last cell in
+each line there is a LF char.
+
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+
+Returns: void */
+void sudoku_print_p(const Grid_T *grid) {
+    int i, j, val;
+    char line[2 * SIZE + 1];
+
+    assert(grid);
+
+    /* write one line at a time */
+    for (i = 0; i < SIZE; i++) {
+        for (j = 0; j < SIZE; j++) {
+            val = grid_read_value_p(grid, i, j);
+            line[2 * j] = sudoku_value_char(val);
+            line[2 * j + 1] = ' ';
+        }
+        line[2 * SIZE - 1] = '\n';
+        line[2 * SIZE] = '\0';
+        fputs(line, stdout);
+    }
+    return;
+}
+
+
+/* sudoku_print:
+
+Writes the given sudoku to stdout. Same as sudoku_print_p() for a grid passed
+by value.
+
+The format is SIZE cells per line (see sudoku_read). After each cell there is
+a space char. Empty cells are denoted by a dot char. After the last cell in
+each line there is a LF char.
 
 Parameters:
 grid: a Grid_T type.
 
 Returns: void */
 void sudoku_print(Grid_T grid) {
+    sudoku_print_p(&grid);
+    return;
+}
+
+
+/* sudoku_print_line_p
+
+Writes the given sudoku to stdout as a single line of SIZE*SIZE cells. Empty
+cells are denoted by a dot char. After the last cell there is a LF char.
+
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+
+Returns: void */
+void sudoku_print_line_p(const Grid_T *grid) {
     int i, j, val;
+    char line[SIZE * SIZE + 2];
 
+    assert(grid);
     for (i = 0; i < SIZE; i++) {
         for (j = 0; j < SIZE; j++) {
-            val = grid_read_value(grid, i, j);
-            if (val) {
-                fprintf(stdout, "%d", val);
-            } else {
-                fprintf(stdout, ".");
-            }
-            if (j != SIZE - 1) {
-                fprintf(stdout, " ");
-            }
+            val = grid_read_value_p(grid, i, j);
+            line[i * SIZE + j] = sudoku_value_char(val);
         }
-        fprintf(stdout, "\n");
     }
+    line[SIZE * SIZE] = '\n';
+    line[SIZE * SIZE + 1] = '\0';
+    fputs(line, stdout);
     return;
 }
 
@@ -134,7 +596,7 @@ Writes to stdout the sudoku errors that appear in the row or
 column or block indicated by index.
 
 Parameters:
-grid: a Grid_T type.
+grid: pointer to a constant Grid_T type.
 show: 0 - error messages will not be printed and the function
       will return when the first error is found.
       1 - all error messages will be printed.
@@ -143,8 +605,20 @@ index: Indicates the index of row or column or block that will be checked
 type: a value of 1 indicates a row, 0 indicates a column, 2 indicates a block.
 
 Returns: 1 if errors were found, 0 otherwise. */
-static int sudoku_errors_rules(Grid_T grid, int show, int index, int type) {
-    int i, val, val_cell, found[SIZE], count, err, row, col;
+static int sudoku_errors_rules(const Grid_T *grid, int show, int index, int type) {
+    int i, val, val_cell, found[SIZE], count, err;
+    const Cell_T *cells;
+
+    /* the cells of the row/column/block (see tables.c) */
+    if (type == 1) {
+        cells = tables_units[index];
+    }
+    else if (type == 0) {
+        cells = tables_units[SIZE + index];
+    }
+    else {
+        cells = tables_units[2 * SIZE + index];
+    }
 
     err = 0;
     for (val = 1; val <= SIZE; val++) {
@@ -152,17 +626,7 @@ static int sudoku_errors_rules(Grid_T grid, int show, int index, int type) {
 
         /* scan the row/column/block i (each have SIZE cells) */
         for (i = 0; i < SIZE; i++) {
-            if (type == 1) {            /* row */
-                val_cell = grid_read_value(grid, index, i);
-            }
-            else if (type == 0) {       /* column */
-                val_cell = grid_read_value(grid, i, index);
-            }
-            else {                      /* block */
-                row = i / BSIZE + (index / BSIZE) * BSIZE;
-                col = i % BSIZE + (index % BSIZE) * BSIZE;
-                val_cell = grid_read_value(grid, row, col);
-            }
+            val_cell = grid_read_cell_value_p(grid, cells[i]);
 
             /* cell value was found in the same row/column/block */
             if (val == val_cell) {
@@ -211,19 +675,19 @@ static int sudoku_errors_rules(Grid_T grid, int show, int index, int type) {
 Writes to stdout the grid errors related to empty cells.
 
 Parameters:
-grid: a Grid_T type.
+grid: pointer to a constant Grid_T type.
 show: 0 - error messages will not be printed and the function
        will return when the first error is found.
       1 - all error messages will be printed.
 
 Returns: 1 if errors were found, 0 otherwise. */
-static int sudoku_errors_empty(Grid_T grid, int show) {
+static int sudoku_errors_empty(const Grid_T *grid, int show) {
     int row, col, val, err, first_print;
 
     err = first_print = 0;
     for (row = 0; row < SIZE; row++) {
         for (col = 0; col < SIZE; col++) {
-            val = grid_read_value(grid, row, col);
+            val = grid_read_value_p(grid, row, col);
 
             /* it's an error if cell is empty */
             if (!val) {
@@ -250,17 +714,68 @@ static int sudoku_errors_empty(Grid_T grid, int show) {
 }
 
 
-/* sudoku_print_errors
+/* sudoku_errors_masks
+
+Finds whether the given sudoku has errors using a single pass over its cells.
+The values of each row, column and block are collected in bitmasks and a value
+is a duplicate if its bit is already set.
+
+Parameters:
+grid: a pointer to a constant Grid_T type.
+allow_empty: A value of zero will only check for the standard rules violations,
+any other value will also consider empty cells as errors.
+
+Returns: 1 if errors were found, 0 otherwise. */
+static int sudoku_errors_masks(const Grid_T *grid, int allow_empty) {
+    int row, col, b, val;
+    Choices_T bit, rows[SIZE], cols[SIZE], blocks[SIZE];
+
+    for (b = 0; b < SIZE; b++) {
+        rows[b] = cols[b] = blocks[b] = 0;
+    }
+    for (row = 0; row < SIZE; row++) {
+        for (col = 0; col < SIZE; col++) {
+            val = grid_read_value_p(grid, row, col);
+            if (!val) {
+                if (allow_empty) {
+                    return 1;
+                }
+                continue;
+            }
+            bit = CHOICE_BIT(val);
+            b = BLOCK(row, col);
+            if ((rows[row] | cols[col] | blocks[b]) & bit) {
+                return 1;
+            }
+            rows[row] |= bit;
+            cols[col] |= bit;
+            blocks[b] |= bit;
+        }
+    }
+    return 0;
+}
+
+
+/* sudoku_print_errors_p
 
 Writes to stdout all rule-related errors of the given sudoku.
 
+Checks: if grid is NULL.
+
 Parameters:
-grid: a Grid_T type.
+grid: pointer to a constant Grid_T type.
 
 Returns: void */
-void sudoku_print_errors(Grid_T grid) {
+void sudoku_print_errors_p(const Grid_T *grid) {
     int i;
 
+    assert(grid);
+
+    /* scan for the detailed errors only if there are any */
+    if (sudoku_is_correct_p(grid, 0)) {
+        return;
+    }
+
     /* Errors related to numbers appearing twice in the same column */
     for (i = 0; i < SIZE; i++) {
         sudoku_errors_rules(grid, 1, i, 0);
@@ -280,51 +795,112 @@ void sudoku_print_errors(Grid_T grid) {
 }
 
 
-/* sudoku_print_empty
+/* sudoku_print_errors
+
+Writes to stdout all rule-related errors of the given sudoku. Same as
+sudoku_print_errors_p() for a grid passed by value.
+
+Parameters:
+grid: a Grid_T type.
+
+Returns: void */
+void sudoku_print_errors(Grid_T grid) {
+    sudoku_print_errors_p(&grid);
+    return;
+}
+
+
+/* sudoku_print_empty_p
 
 Writes to stdout all empty cells of the given sudoku.
 
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+
+Returns: void */
+void sudoku_print_empty_p(const Grid_T *grid) {
+    assert(grid);
+    sudoku_errors_empty(grid, 1);
+    return;
+}
+
+
+/* sudoku_print_empty
+
+Writes to stdout all empty cells of the given sudoku. Same as
+sudoku_print_empty_p() for a grid passed by value.
+
 Parameters:
 grid: a Grid_T type.
 
 Returns: void */
 void sudoku_print_empty(Grid_T grid) {
-    sudoku_errors_empty(grid, 1);
+    sudoku_print_empty_p(&grid);
     return;
 }
 
 
-/* sudoku_is_correct
+/* sudoku_is_correct_p
 
 Checks if the given sudoku does not violate any rule. The additional
 parameter allow_empty controls whether we would want to consider empty
 cells as errors.
 
+Checks: if grid is NULL.
+
 Parameters:
-grid: a Grid_T type.
+grid: pointer to a constant Grid_T type.
 allow_empty: A value of zero will only check for the standard rules violations,
 any other value will also consider empty cells as errors.
 
 Returns:
 if allow_empty != 0: 1 if puzzle is completed and does not violate rules, else 0.
 if allow_empty = 0: 1 if puzzle does not violate rules, else 0. */
-int sudoku_is_correct(Grid_T grid, int allow_empty) {
+int sudoku_is_correct_p(const Grid_T *grid, int allow_empty) {
     int i;
 
-    /* Errors related to sudoku rules */
-    for (i = 0; i < SIZE; i++) {
-        if (sudoku_errors_rules(grid, 0, i, 0) ||    /* column conflict */
-            sudoku_errors_rules(grid, 0, i, 1) ||    /* row conflict */
-            sudoku_errors_rules(grid, 0, i, 2)) {    /* block conflict */
-                return 0;
-        }
-    }
+    assert(grid);
 
-    /* Errors related to empty cells */
-    if (allow_empty && sudoku_errors_empty(grid, 0)) {
-        return 0;
+    /* the rulesok field is kept up to date by grid_update_value, unless the
+    caller set it. When it is known, the puzzle is complete if every row uses
+    all values */
+    if (!grid_rulesok_is_cached_p(grid)) {
+        return !sudoku_errors_masks(grid, allow_empty);
+    }
+    switch (grid_read_rulesok_p(grid)) {
+        case 0:
+            return 0;
+        case 1:
+            for (i = 0; allow_empty && i < SIZE; i++) {
+                if (grid_read_row_used_p(grid, i) != CHOICES_ALL) {
+                    return 0;
+                }
+            }
+            return 1;
+        default:
+            return !sudoku_errors_masks(grid, allow_empty);
     }
-    return 1;
+}
+
+
+/* sudoku_is_correct
+
+Checks if the given sudoku does not violate any rule. The additional parameter
+allow_empty controls whether we would want to consider empty cells as errors.
+Same as sudoku_is_correct_p() for a grid passed by value.
+
+Parameters:
+grid: a Grid_T type.
+allow_empty: A value of zero will only check for the standard rules violations,
+any other value will also consider empty cells as errors.
+
+Returns:
+if allow_empty != 0: 1 if puzzle is completed and does not violate rules, else 0.
+if allow_empty = 0: 1 if puzzle does not violate rules, else 0. */
+int sudoku_is_correct(Grid_T grid, int allow_empty) {
+    return sudoku_is_correct_p(&grid, allow_empty);
 }
 
 
@@ -340,128 +916,347 @@ grid: a pointer to a Grid_T type.
 
 Returns: void */
 static void sudoku_init_choices(Grid_T *grid) {
-    int i, val, choice, row, col, brow, bcol;
+    int row, col;
+    Choices_T used;
 
     assert(grid);
     for (row = 0; row < SIZE; row++) {
         for (col = 0; col < SIZE; col++) {
-            val = grid_read_value(*grid, row, col);
-            grid_clear_choice(grid, row, col, 0);
 
-            /* for filled-in cells set count to 0 and clear all choices */
-            if (val) {
+            /* for filled-in cells clear all choices */
+            if (grid_read_value_p(grid, row, col)) {
                 grid_clear_count(grid, row, col);
-                for (choice = 1; choice <= SIZE; choice++) {
-                    grid_clear_choice(grid, row, col, choice);
-                }
                 continue;
             }
 
-            /* else set count to SIZE and enable all choices-{0} */
-            grid_set_count(grid, row, col);
-            for (choice = 1; choice <= SIZE; choice++) {
-                grid_set_choice(grid, row, col, choice);
-            }
-
-            /* remove the value of (row, col) from the choices of all
-            cells that belong to the row & col that contains (row, col) */
-            for (i = 0; i < SIZE; i++) {
-                val = grid_read_value(*grid, row, i);
-                grid_remove_choice(grid, row, col, val);
-                val = grid_read_value(*grid, i, col);
-                grid_remove_choice(grid, row, col, val);
-            }
-
-            /* remove the value of (row, col) from the choices of all cells
-            that belong to the block that contains (row, col) */
-            for (brow = SUBB(row); brow < SUBB(row) + BSIZE; brow++) {
-                for (bcol = SUBB(col); bcol < SUBB(col) + BSIZE; bcol++) {
-                    val = grid_read_value(*grid, brow, bcol);
-                    grid_remove_choice(grid, row, col, val);
-                }
-            }
+            /* else the choices are the values that are not used in the
+            row, column and block that contain (row, col) */
+            used = grid_read_used_p(grid, row, col);
+            grid_write_choices(grid, row, col,
+                               (Choices_T) (CHOICES_ALL & ~used));
         }
     }
     return;
 }
 
 
-/* sudoku_try_next
+/* sudoku_random
 
-Finds a sudoku cell that has the minimum number of available choices among all
-cells.
+Advances the random number generator of the given solver. The generator is
+xoshiro128** (see https://prng.di.unimi.it/). Its state is 4 words of 32 bits
+that are stored in unsigned longs, since ANSI C has no exact 32-bit type.
 
-Checks: if row and col are NULL.
+Checks: if solver is NULL.
+        if n >= 1.
 
 Parameters:
-grid: a Grid_T type.
-row: pointer to a row index.
-col: pointer to a column index.
+solver: a pointer to a Solver_T type.
+n: the number of possible values.
+
+Returns: a random number from 0 to n-1 */
+static int sudoku_random(Solver_T *solver, int n) {
+    unsigned long *s, result, t;
+
+    assert(solver);
+    assert(n >= 1);
+    s = solver->rng;
+    result = ROTL32(s[1] * 5 & 0xffffffffUL, 7) * 9 & 0xffffffffUL;
+    t = s[1] << 9 & 0xffffffffUL;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = ROTL32(s[3], 11);
+    return (int)(result % n);
+}
 
-Returns: *row and *col are set to the row, col of the cell that has the
-minimum number of choices among all cells. Returns one of its available
-choices (1 to 9) or 0 if such cell does not exist */
-static int sudoku_try_next(Grid_T grid, int *row, int *col) {
-    int rowi, colj, val, choices, min_choices, scanned_cells, filled_cells;
 
-    assert(row);
-    assert(col);
-    *row = -1;
-    *col = -1;
-    scanned_cells = 0;
-    filled_cells = 0;
-    min_choices = SIZE+1;
-
-    /* Pick a random cell (rowi, colj) and scan grid horizontally starting
-    from that cell */
-    rowi = rand() % SIZE;
-    colj = rand() % SIZE;
-    while (scanned_cells != SIZE*SIZE) {
-        while (colj != SIZE && scanned_cells != SIZE*SIZE) {
-            val = grid_read_value(grid, rowi, colj);
-
-            /* skip filled-in cells */
-            if (val) {
-                filled_cells++;
-                colj++;
-                scanned_cells++;
-                continue;
-            }
+/* sudoku_flag_read
 
-            /* puzzle is invalid if there is a cell with 0 choices */
-            choices = grid_read_count(grid, rowi, colj);
-            if (choices == 0) {
-                return 0;
-            }
+Reads a flag that other threads may set at the same time, such as the cancel
+flag of a solver.
 
-            /* update min number of choices */
-            if (choices < min_choices) {
-                *row = rowi;
-                *col = colj;
-                min_choices = choices;
-            }
-            colj++;
-            scanned_cells++;
-        }
-        rowi++;
-        if (rowi == SIZE) {
-            rowi = 0;
-        }
-        colj = 0;
-    }
+Parameters:
+flag: a pointer to the flag, or NULL.
 
-    /* there is no cell with a minimum number of choices if all cells are
-    filled-in */
-    if (filled_cells == SIZE*SIZE) {
+Returns: 1 if the flag is set, 0 if it is not set or flag is NULL */
+static int sudoku_flag_read(volatile int *flag) {
+    if (!flag) {
         return 0;
     }
+#if defined(__GNUC__)
+    return __atomic_load_n(flag, __ATOMIC_RELAXED) != 0;
+#else
+    return *flag != 0;
+#endif
+}
 
-    /* we have now selected a cell, return one of its available choices */
-    val = rand() % SIZE + 1;
-    while (1) {
-        if (grid_choice_is_valid(grid, *row, *col, val)) {
+
+/* sudoku_flag_set
+
+Sets a flag that other threads may read at the same time.
+
+Checks: if flag is NULL.
+
+Parameters:
+flag: a pointer to the flag.
+
+Returns: void */
+static void sudoku_flag_set(volatile int *flag) {
+    assert(flag);
+#if defined(__GNUC__)
+    __atomic_store_n(flag, 1, __ATOMIC_RELAXED);
+#else
+    *flag = 1;
+#endif
+    return;
+}
+
+
+/* sudoku_now
+
+Reads a clock that is not affected by changes of the system time.
+
+Parameters: void
+
+Returns: the time in seconds since an unspecified point */
+static double sudoku_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* sudoku_limit_start
+
+Starts the limits of a new solve: the node budget and the deadline are set
+from the max_nodes and timeout options of the given solver, and the aborted
+flag, the restarts and the state of the deductions are cleared.
+
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+
+Returns: void */
+static void sudoku_limit_start(Solver_T *solver) {
+    int i;
+
+    assert(solver);
+    solver->node_limit = solver->max_nodes;
+    if (solver->max_nodes) {
+        solver->node_limit += solver->nodes;
+    }
+    solver->deadline = 0;
+    if (solver->timeout > 0) {
+        solver->deadline = sudoku_now() + solver->timeout / 1000.0;
+    }
+    solver->aborted = 0;
+    solver->restart_limit = 0;
+    solver->restarts = 0;
+    for (i = 0; i < SUDOKU_DEDUCE_COUNT; i++) {
+        solver->deduce_misses[i] = 0;
+        solver->deduce_skip[i] = 0;
+    }
+    return;
+}
+
+
+/* sudoku_aborted
+
+Finds whether the current search of the given solver must stop because its
+cancel or stop flag is set, it has used its node budget or its deadline has
+passed. The deadline is only checked every DEADLINE_NODES nodes.
+Once a search is aborted, it stays aborted until the next solve.
+
+The search must also stop when it has used the nodes of the current restart
+(see sudoku_solve_restarts), but that does not abort the solve.
+
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+
+Returns: 1 if the search must stop, 0 otherwise */
+static int sudoku_aborted(Solver_T *solver) {
+    assert(solver);
+    if (!solver->aborted &&
+        (sudoku_flag_read(solver->cancel) || sudoku_flag_read(solver->stop) ||
+         (solver->node_limit && solver->nodes >= solver->node_limit) ||
+         (solver->deadline > 0 &&
+          !(solver->nodes & (DEADLINE_NODES - 1)) &&
+          sudoku_now() >= solver->deadline))) {
+        solver->aborted = 1;
+    }
+    return solver->aborted ||
+           (solver->restart_limit && solver->nodes >= solver->restart_limit);
+}
+
+
+/* sudoku_order_value
+
+Picks the choice of the given cell that is tried first by the order option
+of the given solver (see Solver_T), other than SUDOKU_ORDER_RANDOM:
+
+- SUDOKU_ORDER_LCV: the choice that the fewest peers of the cell have, i.e.
+the least constraining value.
+- SUDOKU_ORDER_UNITS: the choice that has the fewest places in the row,
+column or block of the cell, then the least constraining one.
+
+Ties are broken using the random number generator of the solver.
+
+Checks: if solver is NULL.
+        if 0 <= cell < SIZE*SIZE.
+        if the cell has choices.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: pointer to a constant Grid_T type.
+cell: cell index row * SIZE + col.
+
+Returns: one of the choices of the cell (1 to SIZE) */
+static int sudoku_order_value(Solver_T *solver, const Grid_T *grid, int cell) {
+    int val, best, k, i, start, score, best_score;
+    int removed[SIZE + 1], places[SIZE + 1], unit_places[SIZE + 1];
+    Choices_T choices, peer;
+    const Cell_T *cells;
+
+    assert(solver);
+    assert(cell >= 0 && cell < SIZE * SIZE);
+    choices = grid_read_cell_choices_p(grid, cell);
+    assert(choices);
+
+    /* the number of peers that have each choice of the cell, i.e. the
+    choices that placing it would remove */
+    for (val = 1; val <= SIZE; val++) {
+        removed[val] = 0;
+        places[val] = 0;
+    }
+    for (k = 0; k < TABLES_PEERS; k++) {
+        peer = grid_read_cell_choices_p(grid, tables_peers[cell][k]) & choices;
+        for (val = 1; peer; val++) {
+            if (peer & CHOICE_BIT(val)) {
+                removed[val]++;
+                peer &= (Choices_T) ~CHOICE_BIT(val);
+            }
+        }
+    }
+
+    /* the min number of cells of the row, column and block of the cell
+    where each choice can still be placed */
+    if (solver->order == SUDOKU_ORDER_UNITS) {
+        for (i = 0; i < 3; i++) {
+            cells = tables_units[tables_cell_units[cell][i]];
+            for (val = 1; val <= SIZE; val++) {
+                unit_places[val] = 0;
+            }
+            for (k = 0; k < SIZE; k++) {
+                peer = grid_read_cell_choices_p(grid, cells[k]) & choices;
+                for (val = 1; peer; val++) {
+                    if (peer & CHOICE_BIT(val)) {
+                        unit_places[val]++;
+                        peer &= (Choices_T) ~CHOICE_BIT(val);
+                    }
+                }
+            }
+            for (val = 1; val <= SIZE; val++) {
+                if (!i || unit_places[val] < places[val]) {
+                    places[val] = unit_places[val];
+                }
+            }
+        }
+    }
+
+    /* the choice with the lowest score, starting from a random value so that
+    ties are broken randomly */
+    best = 0;
+    best_score = 0;
+    start = sudoku_random(solver, SIZE);
+    for (k = 0; k < SIZE; k++) {
+        val = (start + k) % SIZE + 1;
+        if (!(choices & CHOICE_BIT(val))) {
+            continue;
+        }
+        score = places[val] * (TABLES_PEERS + 1) + removed[val];
+        if (!best || score < best_score) {
+            best = val;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+
+/* sudoku_try_next
+
+Finds a sudoku cell that has the minimum number of available choices among all
+cells. Ties are broken using the random number generator of the solver. The
+value returned is picked by the order option of the solver (see Solver_T).
+
+The cells are taken from the bucket queue of the grid (see Grid_T), so only
+the number of cells of each number of choices is read, not every cell.
+
+Checks: if solver is NULL.
+        if row and col are NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: pointer to a constant Grid_T type.
+row: pointer to a row index.
+col: pointer to a column index.
+
+Returns: *row and *col are set to the row, col of the cell that has the
+minimum number of choices among all cells. Returns one of its available
+choices (1 to SIZE) or 0 if such cell does not exist. In that case *row is -1
+if all cells are filled-in, which means that the sudoku is solved if its
+values were placed from the choices of their cells, else *row and *col are
+set to a cell that has no choices. */
+static int sudoku_try_next(Solver_T *solver, const Grid_T *grid, int *row,
+                           int *col) {
+    int val, cell, count, ncells;
+    Choices_T cell_choices;
+
+    assert(solver);
+    assert(row);
+    assert(col);
+    STATS_ADD(solver, try_next, 1);
+
+    /* puzzle is invalid if there is a cell with 0 choices */
+    if (grid_count_cells_p(grid, 0)) {
+        cell = grid_read_cell_p(grid, 0, 0);
+        *row = cell / SIZE;
+        *col = cell % SIZE;
+        return 0;
+    }
+
+    /* the lowest number of choices that some empty cell has */
+    for (count = 1; count <= SIZE; count++) {
+        if ((ncells = grid_count_cells_p(grid, count))) {
             break;
         }
+    }
+
+    /* there is no cell with a minimum number of choices if all cells are
+    filled-in */
+    if (count > SIZE) {
+        *row = -1;
+        *col = -1;
+        return 0;
+    }
+
+    /* pick a random cell among those, and return one of its available
+    choices */
+    cell = grid_read_cell_p(grid, count, sudoku_random(solver, ncells));
+    *row = cell / SIZE;
+    *col = cell % SIZE;
+    if (count > 1 && solver->order != SUDOKU_ORDER_RANDOM) {
+        return sudoku_order_value(solver, grid, cell);
+    }
+    cell_choices = grid_read_choices_p(grid, *row, *col);
+    val = sudoku_random(solver, SIZE) + 1;
+    while (!(cell_choices & CHOICE_BIT(val))) {
         val++;
         if (val == SIZE + 1) {
             val = 1;
@@ -471,51 +1266,140 @@ static int sudoku_try_next(Grid_T grid, int *row, int *col) {
 }
 
 
+/* sudoku_trail_push
+
+Records a change of the given grid cell in the given trail.
+
+Checks: if 0 <= cell < SIZE*SIZE.
+        if the trail is not full.
+
+Parameters:
+trail: a pointer to a Trail_T type. If NULL, the change is not recorded.
+cell: cell index row * SIZE + col.
+val: the value that was placed in the cell, or 0 if none.
+removed: the choices that were removed from the cell.
+
+Returns: void */
+static void sudoku_trail_push(Trail_T *trail, int cell, int val,
+                              Choices_T removed) {
+    assert(cell >= 0 && cell < SIZE * SIZE);
+    if (!trail) {
+        return;
+    }
+    assert(trail->count < TRAIL_SIZE);
+    trail->entries[trail->count].cell = cell;
+    trail->entries[trail->count].val = val;
+    trail->entries[trail->count].removed = removed;
+    trail->count++;
+    return;
+}
+
+
+/* sudoku_trail_undo
+
+Undoes the changes recorded in the given trail, newest first, until it has
+mark entries.
+
+Checks: if grid is NULL.
+        if trail is NULL.
+        if 0 <= mark <= number of entries.
+
+Parameters:
+grid: a pointer to a Grid_T type.
+trail: a pointer to a Trail_T type.
+mark: the number of entries to keep.
+
+Returns: void */
+static void sudoku_trail_undo(Grid_T *grid, Trail_T *trail, int mark) {
+    int cell;
+    Choices_T choices;
+
+    assert(grid);
+    assert(trail);
+    assert(mark >= 0 && mark <= trail->count);
+    while (trail->count > mark) {
+        trail->count--;
+        cell = trail->entries[trail->count].cell;
+        if (trail->entries[trail->count].val) {
+            grid_update_value(grid, cell / SIZE, cell % SIZE, 0);
+        }
+        choices = grid_read_cell_choices_p(grid, cell);
+        choices |= trail->entries[trail->count].removed;
+        grid_write_cell_choices(grid, cell, choices);
+    }
+    return;
+}
+
+
+/* sudoku_remove_choice
+
+Removes val from the available choices of the given grid cell and records
+the change in the given trail if val was a choice.
+
+Checks: if grid is NULL.
+        if 0 <= cell < SIZE*SIZE.
+        if 1 <= val <= SIZE.
+
+Parameters:
+grid: a pointer to a Grid_T type.
+trail: a pointer to a Trail_T type. If NULL, the change is not recorded.
+cell: cell index row * SIZE + col.
+val: the removed value.
+
+Returns: void */
+static void sudoku_remove_choice(Grid_T *grid, Trail_T *trail, int cell,
+                                 int val) {
+    assert(grid);
+    assert(val >= 1 && val <= SIZE);
+    if (grid_read_cell_choices_p(grid, cell) & CHOICE_BIT(val)) {
+        grid_remove_cell_choice(grid, cell, val);
+        sudoku_trail_push(trail, cell, 0, CHOICE_BIT(val));
+    }
+    return;
+}
+
+
 /* sudoku_set_choice
 
 Sets val as the value of the given sudoku at index (row, col) and removes val
 from the available choices of every cell in the same row, column, and
-corresponding block.
+corresponding block (its peers, see tables.c). The changes are recorded in
+the given trail.
 
 Checks: if grid is NULL.
-        if 0 <= row < 9.
-        if 0 <= col < 9.
-        if 1 <= val <= 9.
+        if 0 <= row < SIZE.
+        if 0 <= col < SIZE.
+        if 1 <= val <= SIZE.
 
 Parameters:
 grid: a pointer to a Grid_T type.
+trail: a pointer to a Trail_T type. If NULL, the changes are not recorded.
 row: row index.
 col: column index.
 val: the inserted value.
 
 Returns: void */
-static void sudoku_set_choice(Grid_T *grid, int row, int col, int val) {
-    int i, choice, brow, bcol;
+static void sudoku_set_choice(Grid_T *grid, Trail_T *trail, int row, int col,
+                              int val) {
+    int k, cell;
+    const Cell_T *peers;
 
     assert(grid);
     assert(row >= 0 && row < SIZE);
     assert(col >= 0 && col < SIZE);
     assert(val >= 1 && val <= SIZE);
+    cell = row * SIZE + col;
+    sudoku_trail_push(trail, cell, val, grid_read_cell_choices_p(grid, cell));
     grid_update_value(grid, row, col, val);
 
-    /* set the number of choices to 0 and clear all choices */
-    grid_clear_count(grid, row, col);
-    for (choice = 1; choice <= SIZE; choice++) {
-        grid_clear_choice(grid, row, col, choice);
-    }
-
-    /* remove val as a choice from all cells in the same row, col */
-    for (i = 0; i < SIZE; i++) {
-        grid_remove_choice(grid, row, i, val);
-        grid_remove_choice(grid, i, col, val);
-    }
+    /* clear all choices */
+    grid_write_cell_choices(grid, cell, 0);
 
-    /* remove val as a choice from all cells that belong to the block
-    that contains (row, col) */
-    for (brow = SUBB(row); brow < SUBB(row) + BSIZE; brow++) {
-        for (bcol = SUBB(col); bcol < SUBB(col) + BSIZE; bcol++) {
-            grid_remove_choice(grid, brow, bcol, val);
-        }
+    /* remove val as a choice from all cells in the same row, column and
+    block */
+    peers = tables_peers[cell];
+    for (k = 0; k < TABLES_PEERS; k++) {
+        sudoku_remove_choice(grid, trail, peers[k], val);
     }
     return;
 }
@@ -526,9 +1410,9 @@ static void sudoku_set_choice(Grid_T *grid, int row, int col, int val) {
 Sets val as the value of the given sudoku at index (row, col).
 
 Checks: if grid is NULL.
-        if 0 <= row < 9.
-        if 0 <= col < 9.
-        if 1 <= val <= 9.
+        if 0 <= row < SIZE.
+        if 0 <= col < SIZE.
+        if 1 <= val <= SIZE.
 
 Parameters:
 grid: a pointer to a Grid_T type.
@@ -552,8 +1436,8 @@ void sudoku_insert_value(Grid_T *grid, int row, int col, int val) {
 Deletes the value of the given sudoku at index (row, col).
 
 Checks: if grid is NULL.
-        if 0 <= row < 9.
-        if 0 <= col < 9.
+        if 0 <= row < SIZE.
+        if 0 <= col < SIZE.
 
 Parameters:
 grid: a pointer to a Grid_T type.
@@ -574,243 +1458,2202 @@ void sudoku_delete_value(Grid_T *grid, int row, int col) {
 
 Generates a random valid sudoku with no empty cells.
 
-Parameters: void
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type that provides the random numbers.
 
 Returns: a Grid_T struct */
-static Grid_T sudoku_generate_complete(void) {
-    int choice, row, col, val, tries;
+static Grid_T sudoku_generate_complete(Solver_T *solver) {
+    int row, col, val, tries, order;
     Grid_T sudoku;
 
-    grid_reset_unique(&sudoku);
-    grid_reset_rulesok(&sudoku);
-    grid_clear_initialized(&sudoku);
+    assert(solver);
+
+    /* the values are tried in random order, so that the grids vary */
+    order = solver->order;
+    solver->order = SUDOKU_ORDER_RANDOM;
 
     /* try to generate a full puzzle 20 times */
     for (tries = 0; tries < 20; tries++) {
 
         /* start with an empty puzzle and initialize cell choices */
+        grid_init(&sudoku);
         for (row = 0; row < SIZE; row++) {
             for (col = 0; col < SIZE; col++) {
-                grid_update_value(&sudoku, row, col, 0);
                 grid_set_count(&sudoku, row, col);
-                grid_clear_choice(&sudoku, row, col, 0);
-                for (choice = 1; choice <= SIZE; choice++) {
-                    grid_set_choice(&sudoku, row, col, choice);
-                }
             }
         }
 
         /* fill random cells starting from the ones that have the min number
         of choices */
-        while((val = sudoku_try_next(sudoku, &row, &col))) {
-            sudoku_set_choice(&sudoku, row, col, val);
+        while((val = sudoku_try_next(solver, &sudoku, &row, &col))) {
+            sudoku_set_choice(&sudoku, NULL, row, col, val);
         }
 
-        if (sudoku_is_correct(sudoku, 1)) {
+        /* all cells are filled-in */
+        if (row == -1) {
+            solver->order = order;
             return sudoku;
         }
     }
 
-    /* if failed 20 times to generate a puzzle, return the one below */
+    /* if failed 20 times to generate a puzzle, permute a valid one */
+    solver->order = order;
+    return sudoku_permute_complete(solver);
+}
+
+
+/* sudoku_shuffle
+
+Sets perm to a random permutation of 0 to n-1 (Fisher-Yates shuffle).
+
+Checks: if solver is NULL.
+        if perm is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type that provides the random numbers.
+perm: array of n ints.
+n: number of elements.
+
+Returns: void */
+static void sudoku_shuffle(Solver_T *solver, int *perm, int n) {
+    int i, j, tmp;
+
+    assert(solver);
+    assert(perm);
+    for (i = 0; i < n; i++) {
+        perm[i] = i;
+    }
+    for (i = n - 1; i > 0; i--) {
+        j = sudoku_random(solver, i + 1);
+        tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+    }
+    return;
+}
+
+
+/* sudoku_permute_lines
+
+Sets lines to a random order of the SIZE rows (or columns) of a grid that
+keeps every block in one piece: the bands of BSIZE lines are shuffled, and
+so are the lines within each band.
+
+Checks: if solver is NULL.
+        if lines is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type that provides the random numbers.
+lines: array of SIZE ints. lines[i] is set to the line that goes to line i.
+
+Returns: void */
+static void sudoku_permute_lines(Solver_T *solver, int *lines) {
+    int i, bands[BSIZE], within[BSIZE];
+
+    assert(solver);
+    assert(lines);
+    sudoku_shuffle(solver, bands, BSIZE);
+    for (i = 0; i < SIZE; i++) {
+        if (i % BSIZE == 0) {
+            sudoku_shuffle(solver, within, BSIZE);
+        }
+        lines[i] = bands[i / BSIZE] * BSIZE + within[i % BSIZE];
+    }
+    return;
+}
+
+
+/* sudoku_permute_complete
+
+Generates a random valid sudoku with no empty cells in constant time. It
+starts from the valid pattern (col + row * BSIZE + row / BSIZE) % SIZE + 1
+and applies random transformations that keep a sudoku valid: relabeling of
+the digits, permutation of the rows within each band and of the bands, the
+same for the columns and stacks, and transposition.
+
+The result is one of the grids that are equivalent to the pattern, so there
+is less variety than with sudoku_generate_complete.
+
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type that provides the random numbers.
+
+Returns: a Grid_T struct */
+static Grid_T sudoku_permute_complete(Solver_T *solver) {
+    int row, col, i, j, tmp, digits[SIZE], rows[SIZE], cols[SIZE], transpose;
+    Grid_T sudoku;
+
+    assert(solver);
+    sudoku_shuffle(solver, digits, SIZE);
+    sudoku_permute_lines(solver, rows);
+    sudoku_permute_lines(solver, cols);
+    transpose = sudoku_random(solver, 2);
+
+    grid_init(&sudoku);
     for (row = 0; row < SIZE; row++) {
         for (col = 0; col < SIZE; col++) {
-            val = (col + row * BSIZE + row / BSIZE) % SIZE + 1;
-            grid_update_value(&sudoku, row, col, val);
+            i = rows[row];
+            j = cols[col];
+            if (transpose) {
+                tmp = i;
+                i = j;
+                j = tmp;
+            }
+            grid_update_value(&sudoku, row, col,
+                              digits[(j + i * BSIZE + i / BSIZE) % SIZE] + 1);
         }
     }
     return sudoku;
 }
 
 
-/* sudoku_generate
+/* sudoku_generate_with_p
 
-Generates a random sudoku with nelts non-zero cells.
+Generates a random sudoku with nelts non-zero cells and stores it in grid. The
+random numbers come from the given solver, so the same seed (see
+sudoku_solver_seed) always generates the same sudoku.
 
 The following algorithm is used:
-1) Generate a random fully completed puzzle.
-2) Clear a random cell and check whether the puzzle has a unique choice
+1) Generate a random fully completed puzzle, as selected by the complete
+option of the solver.
+2) Clear a random cell and check whether the puzzle still has exactly one
 solution.
 3) If yes, repeat previous step. Return when the nelts non-zero requirements
 is met.
-3) If no, pick another cell. If all cells have been tried and all of them
-lead to a non unique choice solution, continue clearing cells until the
+3) If no, restore the cell and pick another one. If all cells have been tried
+and all of them lead to multiple solutions, continue clearing cells until the
 nelts non-zero cells requirement is met.
 
-We can find whether the returned puzzle has a unique choice solution by
-calling sudoku_solution_is_unique() before solving the puzzle.
+The check searches for a second solution with the propagate option of the
+solver, whatever its engine is, with a trail that is allocated once.
+
+The unique field of the returned puzzle is reset to -1, since the check does
+not show whether the puzzle has a unique choice solution. Whether it has
+exactly one solution is returned instead.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if 0 <= nelts <= SIZE*SIZE.
 
 Parameters:
+solver: a pointer to a Solver_T type. Its random number generator is advanced.
 nelts: number of non-zero cells.
+grid: a pointer to a Grid_T type that will hold the sudoku.
 
-Returns: a Grid_T type */
-Grid_T sudoku_generate(int nelts) {
-    int to_remove, row, col, val, has_nontried, unique_choice;
-    int tried[SIZE][SIZE];
-    Grid_T sudoku, sudoku_copy, sudoku_solved;
+Returns: 1 if the sudoku has exactly one solution, 0 if it has several */
+int sudoku_generate_with_p(Solver_T *solver, int nelts, Grid_T *grid) {
+    int to_remove, row, col, val, ntried, unique;
+    char tried[SIZE][SIZE];
+    Grid_T sudoku;
+    Trail_T *trail;
 
+    assert(solver);
+    assert(grid);
     assert(nelts >= 0 && nelts <= SIZE * SIZE);
     to_remove = SIZE * SIZE - nelts;
-    has_nontried = 0;
-    unique_choice = 1;
+    unique = 1;
 
     /* Initialize tried to 0. Set tried(i,j) to 1 if clearing cell (i, j)
-    did not lead to a unique choice solution.  */
+    leads to multiple solutions. Clearing more cells cannot make the solution
+    unique again, so a cell is never tried twice. ntried counts the tried
+    cells */
     for (row = 0; row < SIZE; row++) {
         for (col = 0; col < SIZE; col++) {
             tried[row][col] = 0;
         }
     }
+    ntried = 0;
+    trail = malloc(sizeof(Trail_T));
+    assert(trail);
+    trail->count = 0;
+    trail->depth = 0;
 
     /* generate a random solved puzzle */
-    sudoku = sudoku_generate_complete();
+    if (solver->complete == SUDOKU_COMPLETE_PERMUTE) {
+        sudoku = sudoku_permute_complete(solver);
+    }
+    else {
+        sudoku = sudoku_generate_complete(solver);
+    }
 
     while (to_remove > 0) {
 
+        /* if all filled-in cells have been tried, clearing any cell creates a
+        puzzle that has multiple solutions */
+        if (ntried == nelts + to_remove) {
+            unique = 0;
+        }
+
         /* pick cell (row, col) and proceed only if it still has a value */
-        row = rand() % SIZE;
-        col = rand() % SIZE;
-        if (!grid_read_value(sudoku, row, col)) {
+        row = sudoku_random(solver, SIZE);
+        col = sudoku_random(solver, SIZE);
+        val = grid_read_value_p(&sudoku, row, col);
+        if (!val) {
             continue;
         }
 
-        /* if puzzle cannot have a unique choice solution we only need to
-        clear the cell value and pick another cell */
-        if (!unique_choice) {
+        /* if puzzle cannot have a unique solution we only need to clear the
+        cell value and pick another cell */
+        if (!unique) {
             to_remove--;
             grid_update_value(&sudoku, row, col, 0);
             continue;
         }
 
-        /* if puzzle still has a unique choice solution, we need to
-        pick a different cell if this one has been tried */
+        /* if puzzle still has a unique solution, we need to pick a different
+        cell if this one has been tried */
         if (tried[row][col]) {
             continue;
         }
 
-        /* initialize a copy of puzzle and clear the cell value on the copy */
-        sudoku_copy = sudoku;
-        grid_update_value(&sudoku_copy, row, col, 0);
-        sudoku_init_choices(&sudoku_copy);
-
-        /* solve the copy and if there is a unique choice solution,
-        we'll be using the copy from now on */
-        sudoku_solved = sudoku_solve(sudoku_copy);
-        if (grid_read_unique(sudoku_solved)) {
+        /* clear the cell and keep it cleared if the puzzle still has a
+        unique solution */
+        grid_update_value(&sudoku, row, col, 0);
+        sudoku_init_choices(&sudoku);
+        if (sudoku_count_grid(solver, &sudoku, trail, 2) == 1) {
             to_remove--;
-            sudoku = sudoku_copy;
-            for (row = 0; row < SIZE; row++) {
-                for (col = 0; col < SIZE; col++) {
-                    tried[row][col] = 0;
-                }
-            }
             continue;
         }
 
-        /* if solving the copy did not lead to unique choice solution,
-        set the cell to tried */
+        /* else restore the cell and set it to tried */
+        grid_update_value(&sudoku, row, col, val);
         tried[row][col] = 1;
-
-        /* and search for a new non-tried cell */
-        has_nontried = 0;
-        for (row = 0; row < SIZE; row++) {
-            for (col = 0; col < SIZE; col++) {
-                val = grid_read_value(sudoku, row, col);
-                if (val && !tried[row][col]) {
-                    has_nontried = 1;
-                }
-            }
-        }
-
-        /* if a non-tried cell cannot be found, clearing a cell
-        creates a puzzle that will not have unique choice solution */
-        if (!has_nontried) {
-            unique_choice = 0;
-        }
+        ntried++;
     }
 
-    if (!unique_choice) {
-        grid_clear_unique(&sudoku);
-    }
-    return sudoku;
+    free(trail);
+    grid_reset_unique(&sudoku);
+    *grid = sudoku;
+    return unique;
 }
 
 
-/* sudoku_solve
-
-Solves the given sudoku using recursion (backtracking).
+/* sudoku_generate
 
-- If there are multiple solutions, it returns one of them.
-- If there is no solution, it returns a puzzle that is as close as possible
-to a solution.
-- If the puzzle violates a rule, it returns the initial puzzle.
+Generates a random sudoku with nelts non-zero cells. Same as
+sudoku_generate_with_p() using a solver that is initialized with
+sudoku_solver_init(), so every call with the same nelts returns the same
+sudoku. Use sudoku_generate_with_p() with a seeded solver to get different
+sudokus.
 
 Parameters:
-grid: a Grid_T type
+nelts: number of non-zero cells.
 
 Returns: a Grid_T type */
-Grid_T sudoku_solve(Grid_T grid) {
-    int row, col, val;
-    Grid_T grid_copy;
-
-    /* if puzzle violates any rule */
-    if (grid_read_rulesok(grid) == -1) {
-        if (sudoku_is_correct(grid, 0)) {
-            grid_set_rulesok(&grid);
-        } else {
-            grid_clear_rulesok(&grid);
-        }
-    }
+Grid_T sudoku_generate(int nelts) {
+    Solver_T solver;
+    Grid_T sudoku;
 
-    /* if grid violates sudoku rules */
-    if (!grid_read_rulesok(grid)) {
-        grid_clear_unique(&grid);
-        return grid;
-    }
+    sudoku_solver_init(&solver);
+    sudoku_generate_with_p(&solver, nelts, &sudoku);
+    return sudoku;
+}
 
-    /* initialize cell choices once */
-    if (!grid_is_initialized(grid)) {
-        sudoku_init_choices(&grid);
-        grid_set_initialized(&grid);
-    }
 
-    /* find a cell with min number of choices among all cells */
-    while ((val = sudoku_try_next(grid, &row, &col))) {
+/* sudoku_remove_choices
 
-        /* if there is a cell that has only 1 choice, fill it */
-        if (grid_read_count(grid, row, col) == 1) {
-            sudoku_set_choice(&grid, row, col, val);
-        }
+Removes the given choices from the available choices of the given grid cell
+and records the change in the given trail.
 
-        /* else puzzle does not have a unique choice solution. solve a copy */
-        else {
-            grid_clear_unique(&grid);
-            grid_copy = grid;
-            sudoku_set_choice(&grid_copy, row, col, val);
-            grid_copy = sudoku_solve(grid_copy);
+Checks: if grid is NULL.
+        if 0 <= cell < SIZE*SIZE.
 
-            /* return the copy if solution is correct */
-            if (sudoku_is_correct(grid_copy, 1)) {
-                return grid_copy;
-            }
+Parameters:
+grid: a pointer to a Grid_T type.
+trail: a pointer to a Trail_T type. If NULL, the change is not recorded.
+cell: cell index row * SIZE + col.
+removed: bitmask of the removed values. Values that are not choices of the
+cell are ignored.
 
-            /* else remove the choice from the cell of the original puzzle */
-            else {
-                grid_remove_choice(&grid, row, col, val);
-            }
-        }
-    }
+Returns: the number of choices that were removed */
+static int sudoku_remove_choices(Grid_T *grid, Trail_T *trail, int cell,
+                                 Choices_T removed) {
+    Choices_T choices;
 
-    /* clear unique flag if puzzle not correct */
-    if (grid_read_unique(grid) && !sudoku_is_correct(grid, 1)) {
-        grid_clear_unique(&grid);
+    assert(grid);
+    assert(cell >= 0 && cell < SIZE * SIZE);
+    choices = grid_read_cell_choices_p(grid, cell);
+    removed &= choices;
+    if (!removed) {
+        return 0;
     }
-    return grid;
+    grid_write_cell_choices(grid, cell, (Choices_T) (choices & ~removed));
+    sudoku_trail_push(trail, cell, 0, removed);
+    return grid_count_choices(removed);
 }
 
 
-/* sudoku_has_unique_choice_solution
+/* sudoku_next_subset
 
-Indicates whether the given sudoku has a unique choice solution.
+Advances the given combination of n of the numbers 0 to count-1 to the next
+one in lexicographic order.
+
+Checks: if index is NULL.
+
+Parameters:
+index: array of n increasing numbers from 0 to count-1.
+n: number of elements of the combination.
+count: number of numbers to choose from.
+
+Returns: 0 if index was the last combination, 1 otherwise */
+static int sudoku_next_subset(int *index, int n, int count) {
+    int i;
+
+    assert(index);
+    for (i = n - 1; i >= 0 && index[i] == count - n + i; i--) {
+        ;
+    }
+    if (i < 0) {
+        return 0;
+    }
+    index[i]++;
+    for (i++; i < n; i++) {
+        index[i] = index[i - 1] + 1;
+    }
+    return 1;
+}
+
+
+/* sudoku_deduce_locked
+
+Removes the choices of the given sudoku that are excluded by locked
+candidates, for every row and column line and every block that it crosses:
+- pointing: if the choices of a value in the block are all on the line, the
+value is removed from the cells of the line outside the block.
+- claiming: if the choices of a value on the line are all in the block, the
+value is removed from the cells of the block outside the line.
+
+Checks: if grid is NULL.
+
+Parameters:
+grid: a pointer to a Grid_T type.
+trail: a pointer to a Trail_T type. If NULL, the changes are not recorded.
+
+Returns: the number of choices that were removed */
+static int sudoku_deduce_locked(Grid_T *grid, Trail_T *trail) {
+    int cols, line, box, i, k, band, removed;
+    Choices_T segments[SIZE][BSIZE], rest, only;
+
+    assert(grid);
+    removed = 0;
+    for (cols = 0; cols < 2; cols++) {
+
+        /* segments[line][box]: the choices of the BSIZE cells that the line
+        shares with the box-th block that it crosses */
+        for (line = 0; line < SIZE; line++) {
+            for (box = 0; box < BSIZE; box++) {
+                segments[line][box] = 0;
+                for (k = 0; k < BSIZE; k++) {
+                    segments[line][box] |= grid_read_cell_choices_p(grid,
+                        LINE_CELL(cols, line, box * BSIZE + k));
+                }
+            }
+        }
+
+        for (line = 0; line < SIZE; line++) {
+            band = SUBB(line);
+            for (box = 0; box < BSIZE; box++) {
+
+                /* claiming: the values of the line that are only in this
+                segment */
+                for (i = 0, rest = 0; i < BSIZE; i++) {
+                    if (i != box) {
+                        rest |= segments[line][i];
+                    }
+                }
+                only = (Choices_T) (segments[line][box] & ~rest);
+                for (i = band; only && i < band + BSIZE; i++) {
+                    for (k = 0; i != line && k < BSIZE; k++) {
+                        removed += sudoku_remove_choices(grid, trail,
+                            LINE_CELL(cols, i, box * BSIZE + k), only);
+                    }
+                }
+
+                /* pointing: the values of the block that are only in this
+                segment */
+                for (i = band, rest = 0; i < band + BSIZE; i++) {
+                    if (i != line) {
+                        rest |= segments[i][box];
+                    }
+                }
+                only = (Choices_T) (segments[line][box] & ~rest);
+                for (k = 0; only && k < SIZE; k++) {
+                    if (k / BSIZE != box) {
+                        removed += sudoku_remove_choices(grid, trail,
+                            LINE_CELL(cols, line, k), only);
+                    }
+                }
+            }
+        }
+    }
+    return removed;
+}
+
+
+/* sudoku_deduce_subsets
+
+Removes the choices of the given sudoku that are excluded by the naked and
+hidden subsets of n cells of each row, column and block:
+- naked: if n cells of the unit have only n choices among them, these values
+are removed from the other cells of the unit.
+- hidden: if n values are choices of only n cells of the unit, the other
+choices of these cells are removed.
+
+The choices that were already removed by the subsets of the unit are not
+considered again, so one call may miss subsets that only appear after
+others were applied.
+
+Checks: if grid is NULL.
+        if 2 <= n <= DEDUCE_SUBSET_MAX.
+
+Parameters:
+grid: a pointer to a Grid_T type.
+trail: a pointer to a Trail_T type. If NULL, the changes are not recorded.
+n: the number of cells and values of a subset.
+
+Returns: the number of choices that were removed, or -1 if a contradiction
+was found (n cells with fewer than n choices, or n values that are choices
+of fewer than n cells) */
+static int sudoku_deduce_subsets(Grid_T *grid, Trail_T *trail, int n) {
+    int unit, k, i, val, count, removed, index[DEDUCE_SUBSET_MAX];
+    int members[SIZE];
+    Choices_T masks[SIZE + 1], choices, join, keep;
+    const Cell_T *cells;
+
+    assert(grid);
+    assert(n >= 2 && n <= DEDUCE_SUBSET_MAX);
+    removed = 0;
+    for (unit = 0; unit < 3 * SIZE; unit++) {
+        cells = tables_units[unit];
+
+        /* naked subsets: the cells that have 2 to n choices, and the
+        positions where each value is a choice */
+        for (val = 1; val <= SIZE; val++) {
+            masks[val] = 0;
+        }
+        for (k = 0, count = 0; k < SIZE; k++) {
+            choices = grid_read_cell_choices_p(grid, cells[k]);
+            i = grid_count_choices(choices);
+            if (i >= 2 && i <= n) {
+                members[count++] = k;
+            }
+            for (val = 1; choices; val++) {
+                if (choices & CHOICE_BIT(val)) {
+                    masks[val] |= CHOICE_BIT(k);
+                    choices &= (Choices_T) ~CHOICE_BIT(val);
+                }
+            }
+        }
+        for (i = 0; i < n; i++) {
+            index[i] = i;
+        }
+        while (count >= n) {
+            for (i = 0, join = 0, keep = 0; i < n; i++) {
+                join |= grid_read_cell_choices_p(grid,
+                                                 cells[members[index[i]]]);
+                keep |= CHOICE_BIT(members[index[i]]);
+            }
+            if (grid_count_choices(join) < n) {
+                return -1;
+            }
+            if (grid_count_choices(join) == n) {
+                for (k = 0; k < SIZE; k++) {
+                    if (!(keep & CHOICE_BIT(k))) {
+                        removed += sudoku_remove_choices(grid, trail, cells[k],
+                                                         join);
+                    }
+                }
+            }
+            if (!sudoku_next_subset(index, n, count)) {
+                break;
+            }
+        }
+
+        /* hidden subsets: the values that are choices of 2 to n cells */
+        for (val = 1, count = 0; val <= SIZE; val++) {
+            i = grid_count_choices(masks[val]);
+            if (i >= 2 && i <= n) {
+                members[count++] = val;
+            }
+        }
+        for (i = 0; i < n; i++) {
+            index[i] = i;
+        }
+        while (count >= n) {
+            for (i = 0, join = 0, keep = 0; i < n; i++) {
+                join |= masks[members[index[i]]];
+                keep |= CHOICE_BIT(members[index[i]]);
+            }
+            if (grid_count_choices(join) < n) {
+                return -1;
+            }
+            if (grid_count_choices(join) == n) {
+                for (k = 0; k < SIZE; k++) {
+                    if (join & CHOICE_BIT(k)) {
+                        removed += sudoku_remove_choices(grid, trail, cells[k],
+                            (Choices_T) (CHOICES_ALL & ~keep));
+                    }
+                }
+            }
+            if (!sudoku_next_subset(index, n, count)) {
+                break;
+            }
+        }
+    }
+    return removed;
+}
+
+
+/* sudoku_deduce_xwing
+
+Removes the choices of the given sudoku that are excluded by X-Wings: if a
+value is a choice of exactly 2 cells in each of 2 rows, and these cells are
+in the same 2 columns, the value is in one of the 2 diagonals and is
+removed from the other cells of the 2 columns. The same is done with rows
+and columns swapped.
+
+Checks: if grid is NULL.
+
+Parameters:
+grid: a pointer to a Grid_T type.
+trail: a pointer to a Trail_T type. If NULL, the changes are not recorded.
+
+Returns: the number of choices that were removed */
+static int sudoku_deduce_xwing(Grid_T *grid, Trail_T *trail) {
+    int cols, line, other, pos, val, k, removed;
+    Choices_T positions[SIZE][SIZE + 1], choices;
+
+    assert(grid);
+    removed = 0;
+    for (cols = 0; cols < 2; cols++) {
+
+        /* positions[line][val]: the positions of the line where val is a
+        choice */
+        for (line = 0; line < SIZE; line++) {
+            for (val = 1; val <= SIZE; val++) {
+                positions[line][val] = 0;
+            }
+            for (pos = 0; pos < SIZE; pos++) {
+                choices = grid_read_cell_choices_p(grid,
+                                                   LINE_CELL(cols, line, pos));
+                for (val = 1; choices; val++) {
+                    if (choices & CHOICE_BIT(val)) {
+                        positions[line][val] |= CHOICE_BIT(pos);
+                        choices &= (Choices_T) ~CHOICE_BIT(val);
+                    }
+                }
+            }
+        }
+
+        for (val = 1; val <= SIZE; val++) {
+            for (line = 0; line < SIZE; line++) {
+                if (grid_count_choices(positions[line][val]) != 2) {
+                    continue;
+                }
+                for (other = line + 1; other < SIZE; other++) {
+                    if (positions[other][val] != positions[line][val]) {
+                        continue;
+                    }
+
+                    /* remove val from the 2 crossing lines, except at the
+                    4 corners */
+                    for (pos = 0; pos < SIZE; pos++) {
+                        if (!(positions[line][val] & CHOICE_BIT(pos))) {
+                            continue;
+                        }
+                        for (k = 0; k < SIZE; k++) {
+                            if (k != line && k != other) {
+                                removed += sudoku_remove_choices(grid, trail,
+                                    LINE_CELL(cols, k, pos), CHOICE_BIT(val));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return removed;
+}
+
+
+/* sudoku_deduce
+
+Applies the deductions of the deduce option of the given solver to the given
+sudoku (see Solver_T), from the cheapest one (see sudoku_deductions), until
+one removes a choice.
+
+Each deduction that finds nothing is then skipped by the next calls, for a
+number of calls that grows with its cost and the number of times in a row
+that it found nothing (see DEDUCE_SKIP_MAX). A deduction that removes a
+choice is tried at every call again.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type. Its statistics and the state of its
+deductions are updated.
+grid: a pointer to a Grid_T type. Its choices must be initialized.
+trail: a pointer to a Trail_T type. If NULL, the changes are not recorded.
+
+Returns: the number of choices that were removed, or -1 if a contradiction
+was found */
+static int sudoku_deduce(Solver_T *solver, Grid_T *grid, Trail_T *trail) {
+    int i, k, removed, skip;
+
+    assert(solver);
+    assert(grid);
+    for (i = 0; i < SUDOKU_DEDUCE_COUNT; i++) {
+        if (!(solver->deduce & sudoku_deductions[i])) {
+            continue;
+        }
+        if (solver->deduce_skip[i] > 0) {
+            solver->deduce_skip[i]--;
+            continue;
+        }
+        switch (sudoku_deductions[i]) {
+            case SUDOKU_DEDUCE_LOCKED:
+                removed = sudoku_deduce_locked(grid, trail);
+                break;
+            case SUDOKU_DEDUCE_PAIRS:
+                removed = sudoku_deduce_subsets(grid, trail, 2);
+                break;
+            case SUDOKU_DEDUCE_TRIPLES:
+                removed = sudoku_deduce_subsets(grid, trail, 3);
+                break;
+            default:
+                removed = sudoku_deduce_xwing(grid, trail);
+                break;
+        }
+        if (removed) {
+            solver->deduce_misses[i] = 0;
+            if (removed > 0) {
+                STATS_ADD(solver, eliminations, removed);
+            }
+            return removed;
+        }
+
+        /* the deduction found nothing: skip it for a while */
+        solver->deduce_misses[i]++;
+        skip = sudoku_deduction_costs[i];
+        for (k = 1; k < solver->deduce_misses[i] && skip < DEDUCE_SKIP_MAX;
+             k++) {
+            skip *= 2;
+        }
+        solver->deduce_skip[i] = skip < DEDUCE_SKIP_MAX ? skip :
+                                 DEDUCE_SKIP_MAX;
+    }
+    return 0;
+}
+
+
+/* sudoku_propagate
+
+Fills the cells of the given sudoku that can be deduced without guessing
+until no more such cells are found:
+- naked singles: empty cells that have only one available choice.
+- hidden singles: values that are an available choice of only one cell in a
+row, column or block.
+
+When no more singles are found, the deductions of the deduce option of the
+solver remove choices (see sudoku_deduce), and the singles are looked for
+again if some were removed.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type. Only its statistics and the state of
+its deductions are updated.
+grid: a pointer to a Grid_T type. Its choices must be initialized.
+trail: a pointer to a Trail_T type. If NULL, the changes are not recorded.
+
+Returns: 0 if a contradiction was found (an empty cell without choices, a
+value that cannot be placed anywhere in a unit, or one found by a
+deduction), 1 otherwise. */
+static int sudoku_propagate(Solver_T *solver, Grid_T *grid, Trail_T *trail) {
+    int cell, unit, k, val, changed, removed;
+    Choices_T choices, once, twice, used, singles;
+    const Cell_T *cells;
+
+    assert(solver);
+    assert(grid);
+    do {
+        changed = 0;
+
+        /* naked singles */
+        for (cell = 0; cell < SIZE * SIZE; cell++) {
+            if (grid_read_cell_value_p(grid, cell)) {
+                continue;
+            }
+            choices = grid_read_cell_choices_p(grid, cell);
+            if (!choices) {
+                return 0;
+            }
+
+            /* a single bit is set */
+            if (!(choices & (choices - 1))) {
+                val = 1;
+                while (!(choices & CHOICE_BIT(val))) {
+                    val++;
+                }
+                sudoku_set_choice(grid, trail, cell / SIZE, cell % SIZE, val);
+                STATS_ADD(solver, singles, 1);
+                changed = 1;
+            }
+        }
+
+        /* hidden singles: in each unit find the values that are a choice
+        of exactly one cell */
+        for (unit = 0; unit < 3 * SIZE; unit++) {
+            cells = tables_units[unit];
+            once = twice = used = 0;
+            for (k = 0; k < SIZE; k++) {
+                used |= CHOICE_BIT(grid_read_cell_value_p(grid, cells[k]));
+                choices = grid_read_cell_choices_p(grid, cells[k]);
+                twice |= once & choices;
+                once |= choices;
+            }
+
+            /* some value can be neither found nor placed in this unit */
+            if (((once | used) & CHOICES_ALL) != CHOICES_ALL) {
+                return 0;
+            }
+            singles = (Choices_T) (once & ~twice);
+            for (val = 1; singles; val++) {
+                if (!(singles & CHOICE_BIT(val))) {
+                    continue;
+                }
+                singles &= (Choices_T) ~CHOICE_BIT(val);
+
+                /* a previous placement may have removed the choice */
+                for (k = 0; k < SIZE; k++) {
+                    if (grid_read_cell_choices_p(grid, cells[k]) &
+                        CHOICE_BIT(val)) {
+                        break;
+                    }
+                }
+                if (k == SIZE) {
+                    return 0;
+                }
+                sudoku_set_choice(grid, trail, cells[k] / SIZE,
+                                  cells[k] % SIZE, val);
+                STATS_ADD(solver, singles, 1);
+                changed = 1;
+            }
+        }
+
+        /* without singles, remove choices with the stronger deductions */
+        if (!changed && solver->deduce) {
+            removed = sudoku_deduce(solver, grid, trail);
+            if (removed < 0) {
+                return 0;
+            }
+            changed = removed > 0;
+        }
+    } while (changed);
+    return 1;
+}
+
+
+/* sudoku_check_rules
+
+Finds whether the given sudoku violates any rule, unless it is already known,
+and updates its rulesok field.
+
+Checks: if grid is NULL.
+
+Parameters:
+grid: a pointer to a Grid_T type
+
+Returns: 1 if grid does not violate any sudoku rule, 0 otherwise */
+static int sudoku_check_rules(Grid_T *grid) {
+    assert(grid);
+    if (grid_read_rulesok_p(grid) == -1) {
+        if (sudoku_is_correct_p(grid, 0)) {
+            grid_set_rulesok(grid);
+        } else {
+            grid_clear_rulesok(grid);
+        }
+    }
+    return grid_read_rulesok_p(grid);
+}
+
+
+/* sudoku_solve_grid
+
+Solves the given sudoku in place using recursion (backtracking).
+
+- If there are multiple solutions, grid is set to one of them.
+- If there is no solution, grid is set to a puzzle that is as close as possible
+to a solution.
+- If the puzzle violates a rule, grid keeps its initial values.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: a pointer to a Grid_T type
+depth: the number of branch points above grid.
+
+Returns: 1 if grid was set to a solution, 0 otherwise */
+static int sudoku_solve_grid(Solver_T *solver, Grid_T *grid, int depth) {
+    int row, col, val, found;
+    Grid_T grid_copy;
+
+    assert(solver);
+    assert(grid);
+
+    /* if grid violates sudoku rules */
+    if (!sudoku_check_rules(grid)) {
+        grid_clear_unique(grid);
+        return 0;
+    }
+
+    /* initialize cell choices once */
+    if (!grid_is_initialized_p(grid)) {
+        sudoku_init_choices(grid);
+        grid_set_initialized(grid);
+    }
+
+    while (1) {
+
+        /* stop if the search was cancelled or is out of nodes or time */
+        if (sudoku_aborted(solver)) {
+            break;
+        }
+
+        /* fill the cells that can be deduced before branching */
+        if (solver->propagate && !sudoku_propagate(solver, grid, NULL)) {
+            break;
+        }
+
+        /* find a cell with min number of choices among all cells. The
+        puzzle is solved if all cells are filled-in */
+        if (!(val = sudoku_try_next(solver, grid, &row, &col))) {
+            if (row == -1) {
+                return 1;
+            }
+            break;
+        }
+
+        /* if there is a cell that has only 1 choice, fill it */
+        if (grid_read_count_p(grid, row, col) == 1) {
+            sudoku_set_choice(grid, NULL, row, col, val);
+            STATS_ADD(solver, singles, 1);
+        }
+
+        /* else puzzle does not have a unique choice solution. solve a copy */
+        else {
+            grid_clear_unique(grid);
+            solver->nodes++;
+            STATS_ADD(solver, guesses, 1);
+            STATS_DEPTH(solver, depth + 1);
+            grid_copy = *grid;
+            sudoku_set_choice(&grid_copy, NULL, row, col, val);
+            found = sudoku_solve_grid(solver, &grid_copy, depth + 1);
+
+            /* keep the copy if it was solved */
+            if (found) {
+                *grid = grid_copy;
+                return 1;
+            }
+
+            /* else remove the choice from the cell of the original puzzle */
+            else {
+                STATS_ADD(solver, backtracks, 1);
+                grid_remove_choice(grid, row, col, val);
+            }
+        }
+    }
+
+    /* not solved: clear unique flag */
+    grid_clear_unique(grid);
+    return 0;
+}
+
+
+/* sudoku_solve_dlx
+
+Solves the given sudoku in place using Dancing Links (see dlx.h).
+
+- If there are multiple solutions, grid is set to one of them.
+- If there is no solution or the puzzle violates a rule, grid keeps its
+initial values.
+
+The search does not show whether the puzzle has a unique choice solution, so
+the unique field is always cleared. It stops early under the same cancel,
+max_nodes and timeout options as the backtracking engines.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: a pointer to a Grid_T type
+
+Returns: 1 if grid was set to a solution, 0 otherwise */
+static int sudoku_solve_dlx(Solver_T *solver, Grid_T *grid) {
+    int found;
+
+    assert(solver);
+    assert(grid);
+    found = sudoku_check_rules(grid) &&
+            dlx_solve(grid, grid, &solver->nodes, sudoku_dlx_aborted, solver);
+    grid_clear_unique(grid);
+    return found;
+}
+
+
+/* sudoku_dlx_aborted
+
+Finds whether the DLX search of the given solver must stop (see
+sudoku_aborted), in the form that dlx_solve calls.
+
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+
+Returns: 1 if the search must stop, 0 otherwise */
+static int sudoku_dlx_aborted(void *solver) {
+    assert(solver);
+    return sudoku_aborted(solver);
+}
+
+
+/* sudoku_solve_iterative
+
+Solves the given sudoku in place using backtracking without recursion. Instead
+of solving a copy of the grid at each branch, every change is recorded in a
+trail that is allocated once, and the changes are undone when a branch fails.
+
+- If there are multiple solutions, grid is set to one of them.
+- If there is no solution, grid is set to a puzzle that is as close as possible
+to a solution.
+- If the puzzle violates a rule, grid keeps its initial values.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: a pointer to a Grid_T type
+
+Returns: 1 if grid was set to a solution, 0 otherwise */
+static int sudoku_solve_iterative(Solver_T *solver, Grid_T *grid) {
+    int row, col, val, depth, found;
+    Trail_T *trail;
+
+    assert(solver);
+    assert(grid);
+
+    /* if grid violates sudoku rules */
+    if (!sudoku_check_rules(grid)) {
+        grid_clear_unique(grid);
+        return 0;
+    }
+
+    /* initialize cell choices once */
+    if (!grid_is_initialized_p(grid)) {
+        sudoku_init_choices(grid);
+        grid_set_initialized(grid);
+    }
+
+    trail = malloc(sizeof(Trail_T));
+    assert(trail);
+    trail->count = 0;
+    trail->depth = 0;
+    found = 0;
+    while (1) {
+
+        /* stop if the search was cancelled or is out of nodes or time */
+        if (sudoku_aborted(solver)) {
+            break;
+        }
+
+        /* fill the cells that can be deduced and find a cell with min number
+        of choices. val is 0 if the puzzle is complete or has a cell without
+        choices */
+        val = 0;
+        if (!solver->propagate || sudoku_propagate(solver, grid, trail)) {
+            val = sudoku_try_next(solver, grid, &row, &col);
+            if (!val && row == -1) {
+                found = 1;
+                break;
+            }
+        }
+
+        /* if there is a cell that has only 1 choice, fill it */
+        if (val && grid_read_count_p(grid, row, col) == 1) {
+            sudoku_set_choice(grid, trail, row, col, val);
+            STATS_ADD(solver, singles, 1);
+        }
+
+        /* else puzzle does not have a unique choice solution. try val */
+        else if (val) {
+            grid_clear_unique(grid);
+            solver->nodes++;
+            STATS_ADD(solver, guesses, 1);
+            STATS_DEPTH(solver, trail->depth + 1);
+            depth = trail->depth++;
+            trail->branches[depth].mark = trail->count;
+            trail->branches[depth].cell = row * SIZE + col;
+            trail->branches[depth].val = val;
+            sudoku_set_choice(grid, trail, row, col, val);
+        }
+
+        /* no solution if there is nothing to backtrack to */
+        else if (!trail->depth) {
+            break;
+        }
+
+        /* else undo the last branch and remove its value from the choices of
+        its cell */
+        else {
+            STATS_ADD(solver, backtracks, 1);
+            depth = --trail->depth;
+            sudoku_trail_undo(grid, trail, trail->branches[depth].mark);
+            sudoku_remove_choice(grid, trail, trail->branches[depth].cell,
+                                 trail->branches[depth].val);
+        }
+    }
+    free(trail);
+
+    /* not solved: clear unique flag */
+    if (!found) {
+        grid_clear_unique(grid);
+    }
+    return found;
+}
+
+
+/* sudoku_solve_engine
+
+Solves the given sudoku in place with the engine of the given solver, within
+the limits that were started by sudoku_limit_start.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: a pointer to a Grid_T type
+
+Returns: 1 if grid was set to a solution, 0 otherwise */
+static int sudoku_solve_engine(Solver_T *solver, Grid_T *grid) {
+    assert(solver);
+    assert(grid);
+    switch (solver->engine) {
+        case SUDOKU_ENGINE_DLX:
+            return sudoku_solve_dlx(solver, grid);
+        case SUDOKU_ENGINE_ITERATIVE:
+            return sudoku_solve_iterative(solver, grid);
+        default:
+            return sudoku_solve_grid(solver, grid, 0);
+    }
+}
+
+
+/* sudoku_luby
+
+Finds the given number of the Luby sequence: 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1,
+1, 2, 4, 8, ... The number is 2^(k-1) if i is 2^k - 1, else it is the number
+i - 2^(k-1) + 1, where 2^(k-1) <= i < 2^k - 1.
+
+Checks: if i >= 1.
+
+Parameters:
+i: the index of the number, from 1.
+
+Returns: the number */
+static unsigned long sudoku_luby(unsigned long i) {
+    int k;
+
+    assert(i >= 1);
+    while (1) {
+        for (k = 1; (1UL << k) - 1 < i; k++) {
+            ;
+        }
+        if ((1UL << k) - 1 == i) {
+            return 1UL << (k - 1);
+        }
+        i -= (1UL << (k - 1)) - 1;
+    }
+}
+
+
+/* sudoku_solve_restarts
+
+Solves the given sudoku in place with the engine of the given solver, like
+sudoku_solve_engine, but gives up the search when it has used
+solver->restart_nodes times the next number of the Luby sequence of nodes
+(see sudoku_luby), and starts over from the initial puzzle. Every run
+reseeds the random number generator of the solver from its state at the
+start of the solve plus the number of the run, so every restart makes
+different random choices and the solve can still be repeated from the same
+seed.
+
+The nodes of a restart grow without bound, so the search still finds
+whether the puzzle has a solution, unless it is aborted.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type. Its restarts field is increased by the
+number of restarts.
+grid: a pointer to a Grid_T type
+
+Returns: 1 if grid was set to a solution, 0 otherwise */
+static int sudoku_solve_restarts(Solver_T *solver, Grid_T *grid) {
+    int found;
+    unsigned long run, seed;
+    Grid_T start;
+
+    assert(solver);
+    assert(grid);
+    start = *grid;
+    seed = solver->rng[0];
+    for (run = 1; ; run++) {
+        sudoku_solver_seed(solver, seed + run);
+        solver->restart_limit = solver->nodes +
+                                solver->restart_nodes * sudoku_luby(run);
+        found = sudoku_solve_engine(solver, grid);
+
+        /* stop if the search finished before it used its nodes */
+        if (found || solver->aborted ||
+            solver->nodes < solver->restart_limit) {
+            break;
+        }
+        solver->restarts++;
+        *grid = start;
+    }
+    solver->restart_limit = 0;
+    return found;
+}
+
+
+/* sudoku_solver_init
+
+Initializes the given solver options to their default values:
+- engine: SUDOKU_ENGINE_BACKTRACK
+- propagate: 1
+- deduce: SUDOKU_DEDUCE_LOCKED
+- threads: 1
+- split: 0
+- cancel: NULL
+- stop: NULL
+- complete: SUDOKU_COMPLETE_SEARCH
+- order: SUDOKU_ORDER_RANDOM
+- nodes: 0
+- stats: NULL
+- max_nodes: 0
+- timeout: 0
+- restart_nodes: 0
+- rng: seeded with SUDOKU_SEED, so every new solver makes the same random
+choices and the library never uses the generator of the C library, which is
+shared by all threads. Use sudoku_solver_seed() to get different choices.
+
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+
+Returns: void */
+void sudoku_solver_init(Solver_T *solver) {
+    int i;
+
+    assert(solver);
+    solver->engine = SUDOKU_ENGINE_BACKTRACK;
+    solver->propagate = 1;
+    solver->deduce = SUDOKU_DEDUCE_LOCKED;
+    solver->threads = 1;
+    solver->split = 0;
+    solver->cancel = NULL;
+    solver->complete = SUDOKU_COMPLETE_SEARCH;
+    solver->order = SUDOKU_ORDER_RANDOM;
+    solver->nodes = 0;
+    solver->stats = NULL;
+    solver->max_nodes = 0;
+    solver->timeout = 0;
+    solver->restart_nodes = 0;
+    solver->node_limit = 0;
+    solver->deadline = 0;
+    solver->aborted = 0;
+    solver->stop = NULL;
+    solver->restart_limit = 0;
+    solver->restarts = 0;
+    for (i = 0; i < SUDOKU_DEDUCE_COUNT; i++) {
+        solver->deduce_misses[i] = 0;
+        solver->deduce_skip[i] = 0;
+    }
+    sudoku_solver_seed(solver, SUDOKU_SEED);
+    return;
+}
+
+
+/* sudoku_solver_seed
+
+Sets the state of the random number generator of the given solver. A solver
+that has the same options and seed makes the same choices, so a run can be
+repeated exactly.
+
+The 4 words of the state are derived from the seed with the finalizer of
+MurmurHash3, so close seeds give unrelated states.
+
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+seed: the seed. Only its lower 32 bits are used.
+
+Returns: void */
+void sudoku_solver_seed(Solver_T *solver, unsigned long seed) {
+    int i;
+    unsigned long z;
+
+    assert(solver);
+    for (i = 0; i < 4; i++) {
+        seed = (seed + 0x9e3779b9UL) & 0xffffffffUL;
+        z = seed;
+        z = (z ^ z >> 16) * 0x85ebca6bUL & 0xffffffffUL;
+        z = (z ^ z >> 13) * 0xc2b2ae35UL & 0xffffffffUL;
+        solver->rng[i] = z ^ z >> 16;
+    }
+    return;
+}
+
+
+/* sudoku_solve_with_p
+
+Solves the given sudoku using the engine and options of the given solver, and
+stores the result in solved.
+
+- If there are multiple solutions, solved is set to one of them.
+- If there is no solution, solved is set to a puzzle that is as close as
+possible to a solution (backtracking engines) or to the initial puzzle (DLX
+engine).
+- If the puzzle violates a rule, solved is set to the initial puzzle.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid.
+
+Returns: void */
+void sudoku_solve_with_p(Solver_T *solver, const Grid_T *grid,
+                         Grid_T *solved) {
+    sudoku_solve_status(solver, grid, solved);
+    return;
+}
+
+
+/* sudoku_solve_status
+
+Solves the given sudoku like sudoku_solve_with_p and finds the status of the
+solve from the result of the engine, without checking the result again.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid. It
+is set like in sudoku_solve_with_p.
+
+Returns: SUDOKU_SOLVED, SUDOKU_UNSOLVED, SUDOKU_ABORTED or SUDOKU_INVALID
+(see Result_T) */
+static int sudoku_solve_status(Solver_T *solver, const Grid_T *grid,
+                               Grid_T *solved) {
+    int found;
+#ifdef SUDOKU_STATS
+    struct timespec start, end;
+#endif
+
+    assert(solver);
+    assert(grid);
+    assert(solved);
+#ifdef SUDOKU_STATS
+    clock_gettime(CLOCK_MONOTONIC, &start);
+#endif
+    *solved = *grid;
+    sudoku_limit_start(solver);
+    if (solver->split > 0 && solver->engine != SUDOKU_ENGINE_DLX) {
+        found = sudoku_solve_split(solver, solved);
+    }
+    else if (solver->restart_nodes && solver->engine != SUDOKU_ENGINE_DLX) {
+        found = sudoku_solve_restarts(solver, solved);
+    }
+    else {
+        found = sudoku_solve_engine(solver, solved);
+    }
+#ifdef SUDOKU_STATS
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    STATS_ADD(solver, seconds, (end.tv_sec - start.tv_sec) +
+                               (end.tv_nsec - start.tv_nsec) / 1e9);
+#endif
+
+    /* a solution that was found without guessing is the only one. Every
+    engine checks the rules first, so rulesok is known */
+    if (found) {
+        if (grid_read_unique_p(solved)) {
+            grid_set_unique(solved);
+        }
+        return SUDOKU_SOLVED;
+    }
+    if (!grid_read_rulesok_p(solved)) {
+        return SUDOKU_INVALID;
+    }
+    return solver->aborted ? SUDOKU_ABORTED : SUDOKU_UNSOLVED;
+}
+
+
+/* sudoku_stats_fork
+
+Gives each of the n given copies of solver its own statistics, all 0, so
+that the copies can be used by different threads. Does nothing if solver has
+no statistics or SUDOKU_STATS is not defined.
+
+Checks: if solver is NULL.
+        if copies is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+copies: array of n copies of solver. Their statistics must be released with
+sudoku_stats_join.
+n: the number of copies.
+
+Returns: void */
+static void sudoku_stats_fork(Solver_T *solver, Solver_T *copies, int n) {
+#ifdef SUDOKU_STATS
+    int i;
+    Stats_T *stats;
+
+    assert(solver);
+    assert(copies);
+    if (!solver->stats || n < 1) {
+        return;
+    }
+    stats = calloc(n, sizeof(Stats_T));
+    assert(stats);
+    for (i = 0; i < n; i++) {
+        copies[i].stats = &stats[i];
+    }
+#endif
+    return;
+}
+
+
+/* sudoku_stats_join
+
+Adds the statistics of the n given copies of solver (see sudoku_stats_fork)
+to the statistics of solver and frees them. max_depth is the max over the
+copies.
+
+Checks: if solver is NULL.
+        if copies is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+copies: array of n copies of solver.
+n: the number of copies.
+seconds: 1 to add the times of the copies, 0 if the time of their work is
+already measured by solver.
+
+Returns: void */
+static void sudoku_stats_join(Solver_T *solver, Solver_T *copies, int n,
+                              int seconds) {
+#ifdef SUDOKU_STATS
+    int i;
+    Stats_T *stats;
+
+    assert(solver);
+    assert(copies);
+    if (!solver->stats || n < 1) {
+        return;
+    }
+    stats = solver->stats;
+    for (i = 0; i < n; i++) {
+        if (stats->max_depth < copies[i].stats->max_depth) {
+            stats->max_depth = copies[i].stats->max_depth;
+        }
+        stats->guesses += copies[i].stats->guesses;
+        stats->backtracks += copies[i].stats->backtracks;
+        stats->singles += copies[i].stats->singles;
+        stats->eliminations += copies[i].stats->eliminations;
+        stats->try_next += copies[i].stats->try_next;
+        if (seconds) {
+            stats->seconds += copies[i].stats->seconds;
+        }
+    }
+    free(copies[0].stats);
+#endif
+    return;
+}
+
+
+/* sudoku_solve_bounded_p
+
+Solves the given sudoku like sudoku_solve_with_p, but shows whether the
+search was stopped early by the cancel flag, the max_nodes or the timeout
+option of the solver, instead of returning a partial grid.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid. It
+is set to a solution if one was found and to the initial puzzle otherwise.
+
+Returns: SUDOKU_SOLVED, SUDOKU_UNSOLVED if the puzzle has no solution,
+SUDOKU_ABORTED if the search was stopped early, or SUDOKU_INVALID if the
+puzzle violates a rule. */
+int sudoku_solve_bounded_p(Solver_T *solver, const Grid_T *grid,
+                           Grid_T *solved) {
+    int status;
+    Grid_T result;
+
+    assert(solver);
+    assert(grid);
+    assert(solved);
+    status = sudoku_solve_status(solver, grid, &result);
+    *solved = status == SUDOKU_SOLVED ? result : *grid;
+    return status;
+}
+
+
+/* sudoku_solve_result_p
+
+Solves the given sudoku like sudoku_solve_bounded_p and stores what the
+search found out in result (see Result_T), so that the solution does not
+have to be checked again with sudoku_is_correct_p.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if result is NULL.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grid: pointer to a constant Grid_T type.
+result: pointer to a Result_T type. Its solution is set to a solution if one
+was found and to the initial puzzle otherwise.
+
+Returns: void */
+void sudoku_solve_result_p(Solver_T *solver, const Grid_T *grid,
+                           Result_T *result) {
+    unsigned long nodes;
+
+    assert(solver);
+    assert(grid);
+    assert(result);
+    nodes = solver->nodes;
+    result->status = sudoku_solve_bounded_p(solver, grid, &result->solution);
+    result->unique = result->status == SUDOKU_SOLVED &&
+                     grid_read_unique_p(&result->solution) == 1;
+    result->nodes = solver->nodes - nodes;
+    result->restarts = solver->restarts;
+    return;
+}
+
+
+/* sudoku_batch_init
+
+Prepares a batch of n tasks for the worker threads of the given solver. Each
+of the solver->threads threads (at most n) gets a copy of the solver that
+does not split searches, since the threads are already busy. The seed of the
+batch is taken from the generator of the solver.
+
+Checks: if solver is NULL.
+        if batch is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type. Its random number generator is advanced.
+batch: a pointer to a Batch_T type. It must be released with
+sudoku_batch_done.
+n: the number of tasks.
+
+Returns: void */
+static void sudoku_batch_init(Solver_T *solver, Batch_T *batch, int n) {
+    int i;
+
+    assert(solver);
+    assert(batch);
+    batch->nthreads = solver->threads > 0 ? solver->threads : pool_cpu_count();
+    if (batch->nthreads > n) {
+        batch->nthreads = n;
+    }
+    if (batch->nthreads < 1) {
+        batch->nthreads = 1;
+    }
+    batch->solvers = malloc(batch->nthreads * sizeof(Solver_T));
+    assert(batch->solvers);
+    for (i = 0; i < batch->nthreads; i++) {
+        batch->solvers[i] = *solver;
+        batch->solvers[i].split = 0;
+        batch->solvers[i].nodes = 0;
+    }
+    sudoku_stats_fork(solver, batch->solvers, batch->nthreads);
+    batch->seed = solver->rng[0];
+    sudoku_random(solver, 1);
+    return;
+}
+
+
+/* sudoku_batch_done
+
+Adds the nodes and statistics of the solvers of the given batch to the given
+solver and frees them.
+
+Checks: if solver is NULL.
+        if batch is NULL.
+
+Parameters:
+solver: a pointer to the Solver_T type that the batch was prepared for.
+batch: a pointer to a Batch_T type.
+
+Returns: void */
+static void sudoku_batch_done(Solver_T *solver, Batch_T *batch) {
+    int i;
+
+    assert(solver);
+    assert(batch);
+    for (i = 0; i < batch->nthreads; i++) {
+        solver->nodes += batch->solvers[i].nodes;
+    }
+    sudoku_stats_join(solver, batch->solvers, batch->nthreads, 1);
+    free(batch->solvers);
+    return;
+}
+
+
+/* sudoku_solve_task
+
+Solves the sudoku at the given index of a batch. Called by the worker
+threads of sudoku_solve_batch. The solver of the worker is seeded from the
+index, so the result does not depend on which thread solves the sudoku.
+
+Parameters:
+arg: pointer to a Batch_T type.
+worker: the index of the worker thread.
+index: the index of the sudoku.
+
+Returns: void */
+static void sudoku_solve_task(void *arg, int worker, int index) {
+    Batch_T *batch = arg;
+
+    sudoku_solver_seed(&batch->solvers[worker], batch->seed + index);
+    if (batch->results) {
+        sudoku_solve_result_p(&batch->solvers[worker], &batch->grids[index],
+                              &batch->results[index]);
+    }
+    else {
+        sudoku_solve_with_p(&batch->solvers[worker], &batch->grids[index],
+                            &batch->solved[index]);
+    }
+    return;
+}
+
+
+/* sudoku_solve_batch
+
+Solves the given array of sudokus using the given solver. Same as calling
+sudoku_solve_with_p() for each sudoku, but the sudokus are solved by
+solver->threads worker threads (see pool.h). The threads steal work from
+each other, so a few hard sudokus do not leave the other threads idle.
+
+Each sudoku is solved with its own seed, so the results depend only on the
+state of solver and not on the number of threads.
+
+Checks: if solver is NULL.
+        if grids is NULL.
+        if solved is NULL.
+        if n >= 0.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grids: array of n sudokus.
+solved: array of n sudokus that will hold the results, in the same order as
+grids. It may be the same array as grids.
+n: number of sudokus.
+
+Returns: void */
+void sudoku_solve_batch(Solver_T *solver, const Grid_T *grids,
+                        Grid_T *solved, int n) {
+    Batch_T batch;
+
+    assert(solver);
+    assert(grids);
+    assert(solved);
+    assert(n >= 0);
+    sudoku_batch_init(solver, &batch, n);
+    batch.grids = grids;
+    batch.solved = solved;
+    batch.results = NULL;
+    pool_run(n, batch.nthreads, sudoku_solve_task, &batch);
+    sudoku_batch_done(solver, &batch);
+    return;
+}
+
+
+/* sudoku_solve_batch_results
+
+Solves the given array of sudokus using the given solver like
+sudoku_solve_batch, and stores the result of each sudoku like
+sudoku_solve_result_p().
+
+Checks: if solver is NULL.
+        if grids is NULL.
+        if results is NULL.
+        if n >= 0.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grids: array of n sudokus.
+results: array of n Result_T types, in the same order as grids.
+n: number of sudokus.
+
+Returns: void */
+void sudoku_solve_batch_results(Solver_T *solver, const Grid_T *grids,
+                                Result_T *results, int n) {
+    Batch_T batch;
+
+    assert(solver);
+    assert(grids);
+    assert(results);
+    assert(n >= 0);
+    sudoku_batch_init(solver, &batch, n);
+    batch.grids = grids;
+    batch.solved = NULL;
+    batch.results = results;
+    pool_run(n, batch.nthreads, sudoku_solve_task, &batch);
+    sudoku_batch_done(solver, &batch);
+    return;
+}
+
+
+/* sudoku_generate_task
+
+Generates the sudoku at the given index of a batch. Called by the worker
+threads of sudoku_generate_batch. The solver of the worker is seeded from
+the index, so the result does not depend on which thread generates the
+sudoku.
+
+Parameters:
+arg: pointer to a Batch_T type.
+worker: the index of the worker thread.
+index: the index of the sudoku.
+
+Returns: void */
+static void sudoku_generate_task(void *arg, int worker, int index) {
+    Batch_T *batch = arg;
+
+    sudoku_solver_seed(&batch->solvers[worker], batch->seed + index);
+    sudoku_generate_with_p(&batch->solvers[worker], batch->nelts,
+                           &batch->solved[index]);
+    return;
+}
+
+
+/* sudoku_generate_batch
+
+Generates n random sudokus with nelts non-zero cells. Same as calling
+sudoku_generate_with_p() n times, but the sudokus are generated by
+solver->threads worker threads (see pool.h), each with its own random
+number generator.
+
+Each sudoku is generated with its own seed, so the results depend only on
+the state of solver and not on the number of threads.
+
+Checks: if solver is NULL.
+        if grids is NULL.
+        if 0 <= nelts <= SIZE*SIZE.
+        if n >= 0.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+nelts: number of non-zero cells of each sudoku.
+grids: array of n sudokus that will hold the results.
+n: number of sudokus.
+
+Returns: void */
+void sudoku_generate_batch(Solver_T *solver, int nelts, Grid_T *grids,
+                           int n) {
+    Batch_T batch;
+
+    assert(solver);
+    assert(grids);
+    assert(nelts >= 0 && nelts <= SIZE * SIZE);
+    assert(n >= 0);
+    sudoku_batch_init(solver, &batch, n);
+    batch.solved = grids;
+    batch.nelts = nelts;
+    pool_run(n, batch.nthreads, sudoku_generate_task, &batch);
+    sudoku_batch_done(solver, &batch);
+    return;
+}
+
+
+/* sudoku_split
+
+Expands the search tree of the given sudoku like sudoku_solve_grid, but
+instead of solving the grids of the branches, appends them to the subtasks
+of split once depth levels of branch points have been expanded. Grids that
+are solved before depth is reached are appended as well, grids that have no
+solution are not. The expansion stops when the solver is aborted (see
+sudoku_aborted) or the grids of split cannot be grown.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if split is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: a pointer to a Grid_T type. It is modified.
+depth: the number of levels of branch points to expand.
+split: a pointer to a Split_T type.
+
+Returns: void */
+static void sudoku_split(Solver_T *solver, Grid_T *grid, int depth,
+                         Split_T *split) {
+    int row, col, val, k, size;
+    Choices_T choices;
+    Grid_T grid_copy, *grids;
+
+    assert(solver);
+    assert(grid);
+    assert(split);
+    while (1) {
+        if (split->failed || sudoku_aborted(solver)) {
+            return;
+        }
+        if (solver->propagate && !sudoku_propagate(solver, grid, NULL)) {
+            return;
+        }
+        if (!(val = sudoku_try_next(solver, grid, &row, &col))) {
+            break;
+        }
+        if (grid_read_count_p(grid, row, col) == 1) {
+            sudoku_set_choice(grid, NULL, row, col, val);
+            STATS_ADD(solver, singles, 1);
+            continue;
+        }
+        grid_clear_unique(grid);
+        if (!depth) {
+            break;
+        }
+
+        /* one branch for each choice, starting from val */
+        choices = grid_read_choices_p(grid, row, col);
+        for (k = 0; k < SIZE; k++, val = val % SIZE + 1) {
+            if (choices & CHOICE_BIT(val)) {
+                grid_copy = *grid;
+                sudoku_set_choice(&grid_copy, NULL, row, col, val);
+                sudoku_split(solver, &grid_copy, depth - 1, split);
+            }
+        }
+        return;
+    }
+
+    /* a leaf: a branch point at the last level, or a complete grid */
+    if (!val && row != -1) {
+        return;
+    }
+    if (split->count == split->size) {
+        size = split->size ? 2 * split->size : SIZE;
+        grids = realloc(split->grids, size * sizeof(Grid_T));
+        if (!grids) {
+            split->failed = 1;
+            return;
+        }
+        split->grids = grids;
+        split->size = size;
+    }
+    split->grids[split->count++] = *grid;
+    return;
+}
+
+
+/* sudoku_split_task
+
+Solves a subtask of a split search, unless another subtask has already
+found a solution or the search was cancelled. Called by the worker threads
+of sudoku_solve_split.
+
+Parameters:
+arg: pointer to a Split_T type.
+worker: the index of the worker thread.
+index: the index of the subtask.
+
+Returns: void */
+static void sudoku_split_task(void *arg, int worker, int index) {
+    Split_T *split = arg;
+    Grid_T *grid = &split->grids[index];
+
+    if (sudoku_flag_read(&split->found) || sudoku_flag_read(split->cancel)) {
+        return;
+    }
+    sudoku_solver_seed(&split->solvers[worker], split->seed + index);
+    if (sudoku_solve_engine(&split->solvers[worker], grid)) {
+        split->solved[index] = 1;
+        sudoku_flag_set(&split->found);
+    }
+    return;
+}
+
+
+/* sudoku_solve_split
+
+Solves the given sudoku in place like sudoku_solve_with_p, but splits the
+search tree among solver->threads threads. The first solver->split levels
+of branch points are expanded into subtasks (see sudoku_split) that are run
+on a thread pool. When a subtask finds a solution, the others are cancelled.
+
+- If there are multiple solutions, grid is set to one of them. It may not be
+the same in every run.
+- If there is no solution, grid is set to a puzzle that is as close as
+possible to a solution.
+- If the puzzle violates a rule, grid keeps its initial values.
+- If the subtasks cannot be allocated, the search is aborted without a
+solution.
+
+The cancel flag and the timeout of the solver are also checked while the
+subtasks are expanded. Every thread checks the cancel flag of the solver, so it also stops the
+subtasks in progress, and the found flag of the split through the stop
+field of its solver. The nodes that are left of the max_nodes option of the
+solver are given to each thread.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: a pointer to a Grid_T type
+
+Returns: 1 if grid was set to a solution, 0 otherwise */
+static int sudoku_solve_split(Solver_T *solver, Grid_T *grid) {
+    int i, depth, nthreads, found;
+    Split_T split;
+
+    assert(solver);
+    assert(grid);
+
+    /* if grid violates sudoku rules */
+    if (!sudoku_check_rules(grid)) {
+        grid_clear_unique(grid);
+        return 0;
+    }
+
+    /* initialize cell choices once */
+    if (!grid_is_initialized_p(grid)) {
+        sudoku_init_choices(grid);
+        grid_set_initialized(grid);
+    }
+
+    /* the grids of the subtasks grow as they are appended, since the first
+    branch points often have far fewer than SIZE choices */
+    depth = solver->split < SUDOKU_SPLIT_MAX ? solver->split : SUDOKU_SPLIT_MAX;
+    split.grids = NULL;
+    split.count = 0;
+    split.size = 0;
+    split.failed = 0;
+    split.found = 0;
+    sudoku_split(solver, grid, depth, &split);
+
+    /* without room for the subtasks, the search is given up like an aborted
+    one, since it did not show that there is no solution */
+    nthreads = solver->threads > 0 ? solver->threads : pool_cpu_count();
+    split.solved = calloc(split.count + 1, sizeof(int));
+    split.solvers = malloc(nthreads * sizeof(Solver_T));
+    if (split.failed || !split.solved || !split.solvers) {
+        solver->aborted = 1;
+        grid_clear_unique(grid);
+        free(split.solvers);
+        free(split.solved);
+        free(split.grids);
+        return 0;
+    }
+
+    /* an expansion that was aborted runs no subtasks */
+    if (solver->aborted) {
+        split.count = 0;
+    }
+    for (i = 0; i < nthreads; i++) {
+        split.solvers[i] = *solver;
+        split.solvers[i].split = 0;
+        split.solvers[i].stop = &split.found;
+        split.solvers[i].nodes = 0;
+
+        /* every thread gets the nodes that are left and the same deadline */
+        if (solver->node_limit) {
+            split.solvers[i].node_limit = solver->nodes < solver->node_limit ?
+                                          solver->node_limit - solver->nodes :
+                                          1;
+        }
+    }
+    sudoku_stats_fork(solver, split.solvers, nthreads);
+    split.seed = solver->rng[0];
+    split.cancel = solver->cancel;
+    sudoku_random(solver, 1);
+    pool_run(split.count, nthreads, sudoku_split_task, &split);
+    for (i = 0; i < nthreads; i++) {
+        solver->nodes += split.solvers[i].nodes;
+    }
+    sudoku_stats_join(solver, split.solvers, nthreads, 0);
+
+    /* use the solution of the first subtask that found one. Without a
+    solution, the search was aborted if a thread was aborted (it was not
+    stopped by found) or the cancel flag stopped the remaining subtasks */
+    for (i = 0, found = 0; i < split.count && !found; i++) {
+        if (split.solved[i]) {
+            *grid = split.grids[i];
+            found = 1;
+        }
+    }
+    if (!found) {
+        for (i = 0; i < nthreads; i++) {
+            solver->aborted |= split.solvers[i].aborted;
+        }
+        solver->aborted |= sudoku_flag_read(solver->cancel);
+        grid_clear_unique(grid);
+    }
+    free(split.solvers);
+    free(split.solved);
+    free(split.grids);
+    return found;
+}
+
+
+/* sudoku_solve_p
+
+Solves the given sudoku using recursion (backtracking) and stores the result
+in solved. Uses the default solver options.
+
+- If there are multiple solutions, solved is set to one of them.
+- If there is no solution, solved is set to a puzzle that is as close as
+possible to a solution.
+- If the puzzle violates a rule, solved is set to the initial puzzle.
+
+Checks: if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid.
+
+Returns: void */
+void sudoku_solve_p(const Grid_T *grid, Grid_T *solved) {
+    Solver_T solver;
+
+    sudoku_solver_init(&solver);
+    sudoku_solve_with_p(&solver, grid, solved);
+    return;
+}
+
+
+/* sudoku_solve
+
+Solves the given sudoku using recursion (backtracking). Same as
+sudoku_solve_p() for a grid passed by value.
+
+- If there are multiple solutions, it returns one of them.
+- If there is no solution, it returns a puzzle that is as close as possible
+to a solution.
+- If the puzzle violates a rule, it returns the initial puzzle.
+
+Parameters:
+grid: a Grid_T type
+
+Returns: a Grid_T type */
+Grid_T sudoku_solve(Grid_T grid) {
+    sudoku_solve_p(&grid, &grid);
+    return grid;
+}
+
+
+/* sudoku_count_grid
+
+Counts the solutions of the given sudoku using the same search as
+sudoku_solve_iterative, but instead of stopping at the first solution it
+backtracks to the next branch until limit solutions have been found. All
+changes are undone before returning, so the grid is restored and nothing is
+allocated: with a limit of 2, this is a cheap check of whether a sudoku has
+exactly one solution.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if trail is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+grid: a pointer to a Grid_T type. It must not violate any rule and its
+choices must be initialized.
+trail: a pointer to a Trail_T type that records the changes. Its existing
+entries and branches are kept.
+limit: max number of solutions to count. If 0, all solutions are counted.
+
+Returns: the number of solutions, at most limit */
+static int sudoku_count_grid(Solver_T *solver, Grid_T *grid, Trail_T *trail,
+                             int limit) {
+    int row, col, val, depth, mark, base, count;
+
+    assert(solver);
+    assert(grid);
+    assert(trail);
+    mark = trail->count;
+    base = trail->depth;
+    count = 0;
+    while (1) {
+
+        /* fill the cells that can be deduced and find a cell with min number
+        of choices. val is 0 if the puzzle is complete or has a cell without
+        choices */
+        val = 0;
+        if (!solver->propagate || sudoku_propagate(solver, grid, trail)) {
+            val = sudoku_try_next(solver, grid, &row, &col);
+            if (!val && row == -1 && ++count == limit) {
+                break;
+            }
+        }
+
+        /* if there is a cell that has only 1 choice, fill it */
+        if (val && grid_read_count_p(grid, row, col) == 1) {
+            sudoku_set_choice(grid, trail, row, col, val);
+            STATS_ADD(solver, singles, 1);
+        }
+
+        /* else try val */
+        else if (val) {
+            solver->nodes++;
+            STATS_ADD(solver, guesses, 1);
+            STATS_DEPTH(solver, trail->depth - base + 1);
+            depth = trail->depth++;
+            trail->branches[depth].mark = trail->count;
+            trail->branches[depth].cell = row * SIZE + col;
+            trail->branches[depth].val = val;
+            sudoku_set_choice(grid, trail, row, col, val);
+        }
+
+        /* all branches have been searched */
+        else if (trail->depth == base) {
+            break;
+        }
+
+        /* else undo the last branch and remove its value from the choices of
+        its cell */
+        else {
+            STATS_ADD(solver, backtracks, 1);
+            depth = --trail->depth;
+            sudoku_trail_undo(grid, trail, trail->branches[depth].mark);
+            sudoku_remove_choice(grid, trail, trail->branches[depth].cell,
+                                 trail->branches[depth].val);
+        }
+    }
+    sudoku_trail_undo(grid, trail, mark);
+    trail->depth = base;
+    return count;
+}
+
+
+/* sudoku_count_solutions_p
+
+Counts the solutions of the given sudoku, stopping as soon as limit
+solutions have been found. Unlike sudoku_has_unique_choice_solution_p(),
+which shows whether the solution can be found without guessing, this shows
+whether a sudoku has exactly one solution: a limit of 2 is enough for that.
+
+Checks: if grid is NULL.
+        if limit >= 0.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+limit: max number of solutions to count. If 0, all solutions are counted,
+which may take very long for a sudoku that has few non-zero cells.
+
+Returns: the number of solutions, at most limit. 0 if the sudoku violates a
+rule. */
+int sudoku_count_solutions_p(const Grid_T *grid, int limit) {
+    int count;
+    Grid_T grid_copy;
+    Solver_T solver;
+    Trail_T *trail;
+
+    assert(grid);
+    assert(limit >= 0);
+    grid_copy = *grid;
+    if (!sudoku_check_rules(&grid_copy)) {
+        return 0;
+    }
+    if (!grid_is_initialized_p(&grid_copy)) {
+        sudoku_init_choices(&grid_copy);
+        grid_set_initialized(&grid_copy);
+    }
+
+    /* the count does not depend on the random choices, so the solver keeps
+    the constant seed of sudoku_solver_init */
+    sudoku_solver_init(&solver);
+    trail = malloc(sizeof(Trail_T));
+    assert(trail);
+    trail->count = 0;
+    trail->depth = 0;
+    count = sudoku_count_grid(&solver, &grid_copy, trail, limit);
+    free(trail);
+    return count;
+}
+
+
+/* sudoku_count_solutions
+
+Counts the solutions of the given sudoku, stopping as soon as limit
+solutions have been found. Same as sudoku_count_solutions_p() for a grid
+passed by value.
+
+Parameters:
+grid: a Grid_T type.
+limit: max number of solutions to count. If 0, all solutions are counted.
+
+Returns: the number of solutions, at most limit. 0 if the sudoku violates a
+rule. */
+int sudoku_count_solutions(Grid_T grid, int limit) {
+    return sudoku_count_solutions_p(&grid, limit);
+}
+
+
+/* sudoku_has_unique_choice_solution_p
+
+Indicates whether the given sudoku has a unique choice solution.
+
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns:
+1 if grid has a unique choice solution
+0 if grid does not have a unique choice solution
+-1 if it is not known whether grid has a unique choice solution */
+int sudoku_has_unique_choice_solution_p(const Grid_T *grid) {
+    return grid_read_unique_p(grid);
+}
+
+
+/* sudoku_has_unique_choice_solution
+
+Indicates whether the given sudoku has a unique choice solution. Same as
+sudoku_has_unique_choice_solution_p() for a grid passed by value.
 
 Parameters:
 grid: a Grid_T type
@@ -820,5 +3663,5 @@ Returns:
 0 if grid does not have a unique choice solution
 -1 if it is not known whether grid has a unique choice solution */
 int sudoku_has_unique_choice_solution(Grid_T grid) {
-    return grid_read_unique(grid);
+    return sudoku_has_unique_choice_solution_p(&grid);
 }
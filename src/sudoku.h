@@ -6,12 +6,256 @@
 #include <stdio.h>
 #include "grid.h"
 
+/* max length of an input line, including the LF char */
+#define SUDOKU_LINE_MAX 1024
+
+
+/* solver engines */
+#define SUDOKU_ENGINE_BACKTRACK 0   /* recursion with min choice heuristic */
+#define SUDOKU_ENGINE_DLX 1         /* Dancing Links exact cover search */
+#define SUDOKU_ENGINE_ITERATIVE 2   /* backtracking with an undo trail */
+
+/* how the generator builds a complete grid */
+#define SUDOKU_COMPLETE_SEARCH 0    /* random min choice filling, retried */
+#define SUDOKU_COMPLETE_PERMUTE 1   /* random transformations of a pattern */
+
+/* the order in which the backtracking engines try the values of a cell */
+#define SUDOKU_ORDER_RANDOM 0       /* increasing, from a random value */
+#define SUDOKU_ORDER_LCV 1          /* fewest choices removed from peers */
+#define SUDOKU_ORDER_UNITS 2        /* fewest places in a unit, then LCV */
+
+/* the deductions that the propagation applies besides singles, as flags that
+can be combined (see Solver_T) */
+#define SUDOKU_DEDUCE_LOCKED 1      /* pointing and claiming candidates */
+#define SUDOKU_DEDUCE_PAIRS 2       /* naked and hidden pairs */
+#define SUDOKU_DEDUCE_TRIPLES 4     /* naked and hidden triples */
+#define SUDOKU_DEDUCE_XWING 8       /* X-Wings of rows and columns */
+#define SUDOKU_DEDUCE_ALL 15
+
+/* number of SUDOKU_DEDUCE_* deductions */
+#define SUDOKU_DEDUCE_COUNT 4
+
+/* the seed of the random number generator of a new solver */
+#define SUDOKU_SEED 1
+
+/* max number of levels of branch points that are split among threads */
+#define SUDOKU_SPLIT_MAX 3
+
+/* statuses of a solve (see Result_T) */
+#define SUDOKU_UNSOLVED 0   /* the puzzle has no solution */
+#define SUDOKU_SOLVED 1     /* a solution was found */
+#define SUDOKU_ABORTED 2    /* cancelled, or out of nodes or time */
+#define SUDOKU_INVALID 3    /* the puzzle violates a rule */
+
+
+/* Struct that holds statistics of the searches of a solver, to see how a
+sudoku was solved, e.g. to spot pathological sudokus or to rate their
+difficulty. The library only fills it if it is compiled with SUDOKU_STATS
+defined, otherwise the counting code is left out and the fields stay 0.
+The fields are only increased by the backtracking engines (and the solution
+counts of the generator), except for seconds.
+
+Fields:
+> max_depth: the max number of nested branch points. For batches and split
+searches, the max over all threads.
+
+> guesses: the number of values that were tried at branch points.
+
+> backtracks: the number of values that were tried at branch points and did
+not lead to a solution.
+
+> singles: the number of cells that were filled because they had a single
+choice, or a value could only be placed in that cell of a row, column or
+block.
+
+> eliminations: the number of choices that were removed by the deductions
+of the deduce option of the solver.
+
+> try_next: the number of searches for the cell with the min number of
+choices.
+
+> seconds: the wall clock time spent in sudoku_solve_with_p. For batches, the
+sum of the times of the sudokus.
+*/
+typedef struct stats_s {
+    int max_depth;
+    unsigned long guesses;
+    unsigned long backtracks;
+    unsigned long singles;
+    unsigned long eliminations;
+    unsigned long try_next;
+    double seconds;
+} Stats_T;
+
+
+/* Struct that holds the options of the solver. It should be initialized
+with sudoku_solver_init.
+
+Fields:
+> engine: the algorithm that solves the puzzle, one of SUDOKU_ENGINE_*.
+
+> propagate:
+1: before every branch, fill all naked singles (cells that have only one
+choice) and hidden singles (values that can be placed in only one cell of a
+row, column or block) until no more are found.
+0: only fill the cells that have a single choice, one at a time.
+Used only by the backtracking engines.
+
+> deduce: the SUDOKU_DEDUCE_* flags of the deductions that remove choices
+when propagate is 1 and no more singles are found, before branching:
+SUDOKU_DEDUCE_LOCKED: a value whose choices in a block are all in one row or
+column is removed from the rest of that row or column, and a value whose
+choices in a row or column are all in one block is removed from the rest of
+that block.
+SUDOKU_DEDUCE_PAIRS, SUDOKU_DEDUCE_TRIPLES: if n cells of a row, column or
+block have only n choices among them (naked), these values are removed from
+the other cells of the unit. If n values are choices of only n cells of a
+unit (hidden), the other choices of these cells are removed.
+SUDOKU_DEDUCE_XWING: if a value is a choice of exactly 2 cells in each of 2
+rows, in the same 2 columns, it is removed from the rest of these columns,
+and the same with rows and columns swapped.
+The deductions are tried from the cheapest one, and the singles are looked
+for again as soon as one removes a choice. A deduction that keeps finding
+nothing is skipped for a number of branch points that grows with its cost
+and its misses, so that the expensive ones stop slowing down searches where
+they do not pay off.
+
+> threads: the number of worker threads used by sudoku_solve_batch and by
+split searches. 0 uses one thread per online processor.
+
+> split: the number of levels of branch points (at most SUDOKU_SPLIT_MAX)
+that are expanded before a single sudoku is solved. The grids of the
+branches are then solved in parallel by threads threads, and all of them
+stop as soon as one finds a solution. 0 solves sudokus in a single thread.
+Used only by the backtracking engines.
+
+> cancel: if not NULL, all engines stop as soon as *cancel is nonzero, e.g.
+when it is set by another thread. The result is then not a solution.
+
+> complete: how the generator builds the complete grid that it clears cells
+from, one of SUDOKU_COMPLETE_*. SUDOKU_COMPLETE_SEARCH fills random cells
+and may have to start over, SUDOKU_COMPLETE_PERMUTE shuffles the digits,
+rows and columns of a valid grid in constant time, but can only produce
+grids that are equivalent to that grid.
+
+> order: the order in which the backtracking engines try the values of the
+cell they branch on, one of SUDOKU_ORDER_*. SUDOKU_ORDER_RANDOM starts from
+a random value. SUDOKU_ORDER_LCV first tries the value that is a choice of
+the fewest peers of the cell (the other cells of its row, column and block),
+so it removes the fewest choices from the rest of the grid.
+SUDOKU_ORDER_UNITS first tries the value that has the fewest places left in
+the row, column or block of the cell, and then orders like
+SUDOKU_ORDER_LCV. Ties are broken randomly. The generator always fills its
+complete grids in random order.
+
+> rng: the state of the random number generator that picks the cells and
+values tried by the backtracking engines and the cells cleared by the
+generator. Every solver has its own state, so different solvers can be used
+by different threads at the same time. It should be set with
+sudoku_solver_seed.
+
+> nodes: the number of search nodes, i.e. values tried at branch points by
+the backtracking engines and rows tried by the DLX engine. Every solve adds
+its nodes, including the nodes of the threads of batches and split searches
+and of the solution counts of the generator. Set it to 0 to count the nodes
+of a single solve.
+
+> stats: if not NULL, the statistics of the searches are added to *stats
+(see Stats_T). Set its fields to 0 to get the statistics of a single solve.
+
+> max_nodes: if not 0, all engines stop after max_nodes nodes of a single
+solve. For split searches, it applies to each thread.
+
+> timeout: if not 0, all engines stop when a single solve has taken timeout
+milliseconds.
+
+> restart_nodes: if not 0, the backtracking engines give up a search that has
+not finished after restart_nodes times the next number of the Luby sequence
+(1, 1, 2, 1, 1, 2, 4, 1, 1, 2, ...) nodes, and start over from the initial
+puzzle with a generator reseeded from its state at the start of the solve
+plus the number of the run, so the solve can be repeated from the same seed.
+A search that has taken an unlucky first branch is then cut short instead of
+running for long, which shortens the tail of the solve times of hard
+puzzles. Not used by split searches.
+
+> node_limit, deadline, aborted: the state of the limits of the current
+solve, set by the solve functions. aborted is 1 if the last solve was
+stopped by cancel, max_nodes or timeout.
+
+> stop: if not NULL, the backtracking engines also stop as soon as *stop is
+nonzero. Split searches set it in the solvers of their threads, so that the
+other threads stop when one finds a solution, while cancel still stops all
+of them. NULL after sudoku_solver_init.
+
+> restart_limit, restarts: the state of the restarts of the current solve,
+set by the solve functions. restarts is the number of times that the last
+solve started over.
+
+> deduce_misses, deduce_skip: the state of the deductions of the current
+solve, set by the solve functions: the number of times in a row that each
+deduction found nothing, and the number of times that it will be skipped.
+*/
+typedef struct solver_s {
+    int engine;
+    int propagate;
+    int deduce;
+    int threads;
+    int split;
+    volatile int *cancel;
+    int complete;
+    int order;
+    unsigned long rng[4];
+    unsigned long nodes;
+    Stats_T *stats;
+    unsigned long max_nodes;
+    long timeout;
+    unsigned long restart_nodes;
+    unsigned long node_limit;
+    double deadline;
+    int aborted;
+    volatile int *stop;
+    unsigned long restart_limit;
+    unsigned long restarts;
+    int deduce_misses[SUDOKU_DEDUCE_COUNT];
+    int deduce_skip[SUDOKU_DEDUCE_COUNT];
+} Solver_T;
+
+
+/* Struct that holds the result of a solve, as found by the search itself.
+
+Fields:
+> status: one of SUDOKU_SOLVED, SUDOKU_UNSOLVED, SUDOKU_ABORTED and
+SUDOKU_INVALID.
+
+> unique: 1 if the solution was found without guessing, so it is the only
+solution (see sudoku_has_unique_choice_solution_p). 0 if the puzzle was not
+solved or the search had to guess, in which case there may be other
+solutions (see sudoku_count_solutions_p). Always 0 for the DLX engine.
+
+> nodes: the search nodes of the solve (see Solver_T).
+
+> restarts: the number of times that the search started over (see the
+restart_nodes option of Solver_T).
+
+> solution: the solution if the status is SUDOKU_SOLVED, otherwise the
+initial puzzle.
+*/
+typedef struct result_s {
+    int status;
+    int unique;
+    unsigned long nodes;
+    unsigned long restarts;
+    Grid_T solution;
+} Result_T;
+
 
 /* sudoku_read: Reads a sudoku from stdin.
 
-The accepted format is 9 numbers per line. After each number there is a space
-char. Empty cells are denoted by a dot char. After the last cell in each line
-there is a LF char.  Throws assertion error if format is not met.
+The accepted format is SIZE cells per line. After each cell there is a space
+char. A cell is a number from 1 to 9 or a letter from A for the values from
+10 to SIZE (A is 10, B is 11 and so on, upper or lower case). Empty cells are
+denoted by a dot char. After the last cell in each line there is a LF char.
+Throws assertion error if format is not met.
 
 Example:
 1 . . . . 7 . 9 .
@@ -30,10 +274,71 @@ Returns: a Grid_T type. */
 Grid_T sudoku_read(void);
 
 
-/* sudoku_format_is_correct
+/* sudoku_read_file
+
+Reads the next sudoku from the given stream. Blank lines before the sudoku
+are skipped. Two formats are accepted:
+
+- the format of sudoku_read: SIZE lines of SIZE cells each.
+- a single line of SIZE*SIZE cells.
+
+In both formats a cell is a value from 1 to SIZE (see sudoku_read), or a dot
+char or 0 for an empty cell. Cells may be separated by spaces.
+
+Example of the single line format:
+1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..
+
+Checks: if fp is NULL.
+        if grid is NULL.
+
+Parameters:
+fp: the input stream.
+grid: a pointer to a Grid_T type that will hold the sudoku.
+
+Returns: 1 if a sudoku was read, 0 if the end of the stream was reached
+before a sudoku was found, -1 if the sudoku does not have the correct format. */
+int sudoku_read_file(FILE *fp, Grid_T *grid);
+
+
+/* sudoku_read_lines
+
+Same as sudoku_read_file for a sudoku whose first line has already been read
+from the given stream with fgets, for example to find the size of the grid.
+The remaining lines of the multi-line format are read from the stream.
+
+Checks: if fp is NULL.
+        if line is NULL.
+        if grid is NULL.
+
+Parameters:
+fp: the input stream.
+line: the first non-blank line of the sudoku, as read by fgets with a buffer
+of SUDOKU_LINE_MAX chars.
+grid: a pointer to a Grid_T type that will hold the sudoku.
+
+Returns: 1 if a sudoku was read, -1 if the sudoku does not have the correct
+format. */
+int sudoku_read_lines(FILE *fp, const char *line, Grid_T *grid);
+
+
+/* sudoku_format_is_correct_p
 
 Indicates whether the given sudoku has the correct format.
 
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+
+Returns: 1 if the format is OK, 0 otherwise */
+int sudoku_format_is_correct_p(const Grid_T *grid);
+
+
+/* sudoku_format_is_correct
+
+Indicates whether the given sudoku has the correct format. Same as
+sudoku_format_is_correct_p() for a grid passed by value.
+
 Parameters:
 grid: a Grid_T type.
 
@@ -41,13 +346,31 @@ Returns: 1 if the format is OK, 0 otherwise */
 int sudoku_format_is_correct(Grid_T grid);
 
 
-/* sudoku_print:
+/* sudoku_print_p:
 
 Writes the given sudoku to stdout.
 
-The format is 9 numbers per line. After each number there is a space char.
-Empty cells are denoted by a dot char. After the last cell in each line there
-is a LF char.
+The format is SIZE cells per line (see sudoku_read). After each cell there is
+a space char. Empty cells are denoted by a dot char. After the last cell in
+each line there is a LF char.
+
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+
+Returns: void */
+void sudoku_print_p(const Grid_T *grid);
+
+
+/* sudoku_print:
+
+Writes the given sudoku to stdout. Same as sudoku_print_p() for a grid passed
+by value.
+
+The format is SIZE cells per line (see sudoku_read). After each cell there is
+a space char. Empty cells are denoted by a dot char. After the last cell in
+each line there is a LF char.
 
 Parameters:
 grid: a Grid_T type.
@@ -56,10 +379,38 @@ Returns: void */
 void sudoku_print(Grid_T grid);
 
 
-/* sudoku_print_errors
+/* sudoku_print_line_p
+
+Writes the given sudoku to stdout as a single line of SIZE*SIZE cells. Empty
+cells are denoted by a dot char. After the last cell there is a LF char.
+
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+
+Returns: void */
+void sudoku_print_line_p(const Grid_T *grid);
+
+
+/* sudoku_print_errors_p
 
 Writes to stdout all rule-related errors of the given sudoku.
 
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+
+Returns: void */
+void sudoku_print_errors_p(const Grid_T *grid);
+
+
+/* sudoku_print_errors
+
+Writes to stdout all rule-related errors of the given sudoku. Same as
+sudoku_print_errors_p() for a grid passed by value.
+
 Parameters:
 grid: a Grid_T type.
 
@@ -67,10 +418,24 @@ Returns: void */
 void sudoku_print_errors(Grid_T grid);
 
 
-/* sudoku_print_empty
+/* sudoku_print_empty_p
 
 Writes to stdout all empty cells of the given sudoku.
 
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+
+Returns: void */
+void sudoku_print_empty_p(const Grid_T *grid);
+
+
+/* sudoku_print_empty
+
+Writes to stdout all empty cells of the given sudoku. Same as
+sudoku_print_empty_p() for a grid passed by value.
+
 Parameters:
 grid: a Grid_T type.
 
@@ -78,12 +443,31 @@ Returns: void */
 void sudoku_print_empty(Grid_T grid);
 
 
-/* sudoku_is_correct
+/* sudoku_is_correct_p
 
 Checks if the given sudoku does not violate any rule. The additional
 parameter allow_empty controls whether we would want to consider empty
 cells as errors.
 
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+allow_empty: A value of zero will only check for the standard rules violations,
+any other value will also consider empty cells as errors.
+
+Returns:
+if allow_empty != 0: 1 if puzzle is completed and does not violate rules, else 0.
+if allow_empty = 0: 1 if puzzle does not violate rules, else 0. */
+int sudoku_is_correct_p(const Grid_T *grid, int allow_empty);
+
+
+/* sudoku_is_correct
+
+Checks if the given sudoku does not violate any rule. The additional parameter
+allow_empty controls whether we would want to consider empty cells as errors.
+Same as sudoku_is_correct_p() for a grid passed by value.
+
 Parameters:
 grid: a Grid_T type.
 allow_empty: A value of zero will only check for the standard rules violations,
@@ -95,9 +479,198 @@ if allow_empty = 0: 1 if puzzle does not violate rules, else 0. */
 int sudoku_is_correct(Grid_T grid, int allow_empty);
 
 
+/* sudoku_solver_init
+
+Initializes the given solver options to their default values:
+- engine: SUDOKU_ENGINE_BACKTRACK
+- propagate: 1
+- deduce: SUDOKU_DEDUCE_LOCKED
+- threads: 1
+- split: 0
+- cancel: NULL
+- stop: NULL
+- complete: SUDOKU_COMPLETE_SEARCH
+- order: SUDOKU_ORDER_RANDOM
+- nodes: 0
+- stats: NULL
+- max_nodes: 0
+- timeout: 0
+- restart_nodes: 0
+- rng: seeded with SUDOKU_SEED, so every new solver makes the same random
+choices and the library never uses the generator of the C library, which is
+shared by all threads. Use sudoku_solver_seed() to get different choices.
+
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+
+Returns: void */
+void sudoku_solver_init(Solver_T *solver);
+
+
+/* sudoku_solver_seed
+
+Sets the state of the random number generator of the given solver. A solver
+that has the same options and seed makes the same choices, so a run can be
+repeated exactly.
+
+The 4 words of the state are derived from the seed with the finalizer of
+MurmurHash3, so close seeds give unrelated states.
+
+Checks: if solver is NULL.
+
+Parameters:
+solver: a pointer to a Solver_T type.
+seed: the seed. Only its lower 32 bits are used.
+
+Returns: void */
+void sudoku_solver_seed(Solver_T *solver, unsigned long seed);
+
+
+/* sudoku_solve_with_p
+
+Solves the given sudoku using the engine and options of the given solver, and
+stores the result in solved.
+
+- If there are multiple solutions, solved is set to one of them.
+- If there is no solution, solved is set to a puzzle that is as close as
+possible to a solution (backtracking engines) or to the initial puzzle (DLX
+engine).
+- If the puzzle violates a rule, solved is set to the initial puzzle.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid.
+
+Returns: void */
+void sudoku_solve_with_p(Solver_T *solver, const Grid_T *grid,
+                         Grid_T *solved);
+
+
+/* sudoku_solve_bounded_p
+
+Solves the given sudoku like sudoku_solve_with_p, but shows whether the
+search was stopped early by the cancel flag, the max_nodes or the timeout
+option of the solver, instead of returning a partial grid.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid. It
+is set to a solution if one was found and to the initial puzzle otherwise.
+
+Returns: SUDOKU_SOLVED, SUDOKU_UNSOLVED if the puzzle has no solution,
+SUDOKU_ABORTED if the search was stopped early, or SUDOKU_INVALID if the
+puzzle violates a rule. */
+int sudoku_solve_bounded_p(Solver_T *solver, const Grid_T *grid,
+                           Grid_T *solved);
+
+
+/* sudoku_solve_result_p
+
+Solves the given sudoku like sudoku_solve_bounded_p and stores what the
+search found out in result (see Result_T), so that the solution does not
+have to be checked again with sudoku_is_correct_p.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if result is NULL.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grid: pointer to a constant Grid_T type.
+result: pointer to a Result_T type. Its solution is set to a solution if one
+was found and to the initial puzzle otherwise.
+
+Returns: void */
+void sudoku_solve_result_p(Solver_T *solver, const Grid_T *grid,
+                           Result_T *result);
+
+
+/* sudoku_solve_batch
+
+Solves the given array of sudokus using the given solver. Same as calling
+sudoku_solve_with_p() for each sudoku, but the sudokus are solved by
+solver->threads worker threads (see pool.h). The threads steal work from
+each other, so a few hard sudokus do not leave the other threads idle.
+
+Each sudoku is solved with its own seed, so the results depend only on the
+state of solver and not on the number of threads.
+
+Checks: if solver is NULL.
+        if grids is NULL.
+        if solved is NULL.
+        if n >= 0.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grids: array of n sudokus.
+solved: array of n sudokus that will hold the results, in the same order as
+grids. It may be the same array as grids.
+n: number of sudokus.
+
+Returns: void */
+void sudoku_solve_batch(Solver_T *solver, const Grid_T *grids,
+                        Grid_T *solved, int n);
+
+
+/* sudoku_solve_batch_results
+
+Solves the given array of sudokus using the given solver like
+sudoku_solve_batch, and stores the result of each sudoku like
+sudoku_solve_result_p().
+
+Checks: if solver is NULL.
+        if grids is NULL.
+        if results is NULL.
+        if n >= 0.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+grids: array of n sudokus.
+results: array of n Result_T types, in the same order as grids.
+n: number of sudokus.
+
+Returns: void */
+void sudoku_solve_batch_results(Solver_T *solver, const Grid_T *grids,
+                                Result_T *results, int n);
+
+
+/* sudoku_solve_p
+
+Solves the given sudoku using recursion (backtracking) and stores the result
+in solved. Uses the default solver options.
+
+- If there are multiple solutions, solved is set to one of them.
+- If there is no solution, solved is set to a puzzle that is as close as
+possible to a solution.
+- If the puzzle violates a rule, solved is set to the initial puzzle.
+
+Checks: if grid is NULL.
+        if solved is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+solved: pointer to a Grid_T type. It may point to the same grid as grid.
+
+Returns: void */
+void sudoku_solve_p(const Grid_T *grid, Grid_T *solved);
+
+
 /* sudoku_solve
 
-Solves the given sudoku using recursion (backtracking).
+Solves the given sudoku using recursion (backtracking). Same as
+sudoku_solve_p() for a grid passed by value.
 
 - If there are multiple solutions, it returns one of them.
 - If there is no solution, it returns a puzzle that is as close as possible
@@ -111,10 +684,62 @@ Returns: a Grid_T type */
 Grid_T sudoku_solve(Grid_T grid);
 
 
-/* sudoku_has_unique_choice_solution
+/* sudoku_count_solutions_p
+
+Counts the solutions of the given sudoku, stopping as soon as limit
+solutions have been found. Unlike sudoku_has_unique_choice_solution_p(),
+which shows whether the solution can be found without guessing, this shows
+whether a sudoku has exactly one solution: a limit of 2 is enough for that.
+
+Checks: if grid is NULL.
+        if limit >= 0.
+
+Parameters:
+grid: pointer to a constant Grid_T type.
+limit: max number of solutions to count. If 0, all solutions are counted,
+which may take very long for a sudoku that has few non-zero cells.
+
+Returns: the number of solutions, at most limit. 0 if the sudoku violates a
+rule. */
+int sudoku_count_solutions_p(const Grid_T *grid, int limit);
+
+
+/* sudoku_count_solutions
+
+Counts the solutions of the given sudoku, stopping as soon as limit
+solutions have been found. Same as sudoku_count_solutions_p() for a grid
+passed by value.
+
+Parameters:
+grid: a Grid_T type.
+limit: max number of solutions to count. If 0, all solutions are counted.
+
+Returns: the number of solutions, at most limit. 0 if the sudoku violates a
+rule. */
+int sudoku_count_solutions(Grid_T grid, int limit);
+
+
+/* sudoku_has_unique_choice_solution_p
 
 Indicates whether the given sudoku has a unique choice solution.
 
+Checks: if grid is NULL.
+
+Parameters:
+grid: pointer to a constant Grid_T type
+
+Returns:
+1 if grid has a unique choice solution
+0 if grid does not have a unique choice solution
+-1 if it is not known whether grid has a unique choice solution */
+int sudoku_has_unique_choice_solution_p(const Grid_T *grid);
+
+
+/* sudoku_has_unique_choice_solution
+
+Indicates whether the given sudoku has a unique choice solution. Same as
+sudoku_has_unique_choice_solution_p() for a grid passed by value.
+
 Parameters:
 grid: a Grid_T type
 
@@ -125,22 +750,76 @@ Returns:
 int sudoku_has_unique_choice_solution(Grid_T grid);
 
 
-/* sudoku_generate
+/* sudoku_generate_with_p
 
-Generates a random sudoku with nelts non-zero cells.
+Generates a random sudoku with nelts non-zero cells and stores it in grid. The
+random numbers come from the given solver, so the same seed (see
+sudoku_solver_seed) always generates the same sudoku.
 
 The following algorithm is used:
-1) Generate a random fully completed puzzle.
-2) Clear a random cell and check whether the puzzle has a unique choice
+1) Generate a random fully completed puzzle, as selected by the complete
+option of the solver.
+2) Clear a random cell and check whether the puzzle still has exactly one
 solution.
 3) If yes, repeat previous step. Return when the nelts non-zero requirements
 is met.
-3) If no, pick another cell. If all cells have been tried and all of them
-lead to a non unique choice solution, continue clearing cells until the
+3) If no, restore the cell and pick another one. If all cells have been tried
+and all of them lead to multiple solutions, continue clearing cells until the
 nelts non-zero cells requirement is met.
 
-We can find whether the returned puzzle has a unique choice solution by
-calling sudoku_solution_is_unique() before solving the puzzle.
+The check searches for a second solution with the propagate option of the
+solver, whatever its engine is, with a trail that is allocated once.
+
+The unique field of the returned puzzle is reset to -1, since the check does
+not show whether the puzzle has a unique choice solution. Whether it has
+exactly one solution is returned instead.
+
+Checks: if solver is NULL.
+        if grid is NULL.
+        if 0 <= nelts <= SIZE*SIZE.
+
+Parameters:
+solver: a pointer to a Solver_T type. Its random number generator is advanced.
+nelts: number of non-zero cells.
+grid: a pointer to a Grid_T type that will hold the sudoku.
+
+Returns: 1 if the sudoku has exactly one solution, 0 if it has several */
+int sudoku_generate_with_p(Solver_T *solver, int nelts, Grid_T *grid);
+
+
+/* sudoku_generate_batch
+
+Generates n random sudokus with nelts non-zero cells. Same as calling
+sudoku_generate_with_p() n times, but the sudokus are generated by
+solver->threads worker threads (see pool.h), each with its own random
+number generator.
+
+Each sudoku is generated with its own seed, so the results depend only on
+the state of solver and not on the number of threads.
+
+Checks: if solver is NULL.
+        if grids is NULL.
+        if 0 <= nelts <= SIZE*SIZE.
+        if n >= 0.
+
+Parameters:
+solver: pointer to a Solver_T type. Its random number generator is advanced.
+nelts: number of non-zero cells of each sudoku.
+grids: array of n sudokus that will hold the results.
+n: number of sudokus.
+
+Returns: void */
+void sudoku_generate_batch(Solver_T *solver, int nelts, Grid_T *grids,
+                           int n);
+
+
+/* sudoku_generate
+
+Generates a random sudoku with nelts non-zero cells. Same as
+sudoku_generate_with_p() using a solver that is initialized with
+sudoku_solver_init(), so every call with the same nelts returns the same
+sudoku. Use sudoku_generate_with_p() with a seeded solver to get different
+sudokus.
 
 Parameters:
 nelts: number of non-zero cells.
@@ -154,9 +833,9 @@ Grid_T sudoku_generate(int nelts);
 Sets val as the value of the given sudoku at index (row, col).
 
 Checks: if grid is NULL.
-        if 0 <= row < 9.
-        if 0 <= col < 9.
-        if 1 <= val <= 9.
+        if 0 <= row < SIZE.
+        if 0 <= col < SIZE.
+        if 1 <= val <= SIZE.
 
 Parameters:
 grid: a pointer to a Grid_T type.
@@ -173,8 +852,8 @@ void sudoku_insert_value(Grid_T *grid, int row, int col, int val);
 Deletes the value of the given sudoku at index (row, col).
 
 Checks: if grid is NULL.
-        if 0 <= row < 9.
-        if 0 <= col < 9.
+        if 0 <= row < SIZE.
+        if 0 <= col < SIZE.
 
 Parameters:
 grid: a pointer to a Grid_T type.
@@ -0,0 +1,154 @@
+/* Generates tables.h: the lookup tables of the cells of a grid for each block
+size, so that the solver does not compute the rows, columns and blocks of the
+cells with divisions while it searches.
+
+Use (make does this before compiling sudoku.c):
+./tables > tables.h */
+
+#include <stdio.h>
+
+/* the smallest and largest block size, as in grid.h */
+#define TABLES_BSIZE_MIN 2
+#define TABLES_BSIZE_MAX 5
+
+/* max number of values of a line of the output */
+#define TABLES_LINE 12
+
+static void tables_print_values(const int *values, int n);
+static void tables_print_size(int bsize);
+
+
+/* main
+
+Writes tables.h to stdout. For each block size BSIZE the header has:
+
+TABLES_PEERS: the number of peers of a cell, i.e. the other cells of its
+row, column and block.
+
+tables_peers[SIZE*SIZE][TABLES_PEERS]: the peers of each cell, as indexes
+row * SIZE + col, in increasing order.
+
+tables_units[3*SIZE][SIZE]: the cells of each unit. Units 0 to SIZE-1 are the
+rows, units SIZE to 2*SIZE-1 are the columns and units 2*SIZE to 3*SIZE-1 are
+the blocks, numbered like BLOCK in grid.h.
+
+tables_cell_units[SIZE*SIZE][3]: the row, column and block unit of each
+cell.
+
+Returns: 0 */
+int main(void) {
+    int bsize;
+
+    printf("/* Lookup tables of the cells of a grid. Generated by tables.c, "
+           "do not edit */\n\n");
+    printf("#ifndef _TABLES_H_\n#define _TABLES_H_\n\n");
+    for (bsize = TABLES_BSIZE_MIN; bsize <= TABLES_BSIZE_MAX; bsize++) {
+        printf("%s BSIZE == %d\n\n", bsize == TABLES_BSIZE_MIN ? "#if" :
+                                     "#elif", bsize);
+        tables_print_size(bsize);
+    }
+    printf("#endif\n\n#endif\n");
+    return 0;
+}
+
+
+/* tables_print_values
+
+Writes the given values as the initializer of a one dimensional array,
+TABLES_LINE values per line.
+
+Parameters:
+values: array of n values.
+n: number of values.
+
+Returns: void */
+static void tables_print_values(const int *values, int n) {
+    int i;
+
+    printf("    {");
+    for (i = 0; i < n; i++) {
+        if (i && i % TABLES_LINE == 0) {
+            printf("\n     ");
+        }
+        printf("%s%d", i % TABLES_LINE ? ", " : "", values[i]);
+        if (i % TABLES_LINE == TABLES_LINE - 1 && i < n - 1) {
+            printf(",");
+        }
+    }
+    printf("}");
+    return;
+}
+
+
+/* tables_print_size
+
+Writes the tables of the given block size (see main).
+
+Parameters:
+bsize: block size, from TABLES_BSIZE_MIN to TABLES_BSIZE_MAX.
+
+Returns: void */
+static void tables_print_size(int bsize) {
+    int size, npeers, cell, row, col, block, unit, k, n;
+    int values[TABLES_BSIZE_MAX * TABLES_BSIZE_MAX * 3];
+
+    size = bsize * bsize;
+    npeers = 3 * (size - 1) - 2 * (bsize - 1);
+    printf("#define TABLES_PEERS %d\n\n", npeers);
+
+    /* the peers of a cell in increasing order: the cells that share its
+    row, column or block */
+    printf("static const Cell_T tables_peers[%d][TABLES_PEERS] = {\n",
+           size * size);
+    for (cell = 0; cell < size * size; cell++) {
+        row = cell / size;
+        col = cell % size;
+        block = (row / bsize) * bsize + col / bsize;
+        for (k = 0, n = 0; k < size * size; k++) {
+            if (k != cell && (k / size == row || k % size == col ||
+                ((k / size) / bsize) * bsize + (k % size) / bsize == block)) {
+                values[n++] = k;
+            }
+        }
+        tables_print_values(values, n);
+        printf("%s\n", cell < size * size - 1 ? "," : "");
+    }
+    printf("};\n\n");
+
+    /* the cells of the rows, columns and blocks */
+    printf("static const Cell_T tables_units[%d][%d] = {\n", 3 * size, size);
+    for (unit = 0; unit < 3 * size; unit++) {
+        for (k = 0; k < size; k++) {
+            if (unit < size) {
+                values[k] = unit * size + k;
+            }
+            else if (unit < 2 * size) {
+                values[k] = k * size + unit - size;
+            }
+            else {
+                block = unit - 2 * size;
+                row = (block / bsize) * bsize + k / bsize;
+                col = (block % bsize) * bsize + k % bsize;
+                values[k] = row * size + col;
+            }
+        }
+        tables_print_values(values, size);
+        printf("%s\n", unit < 3 * size - 1 ? "," : "");
+    }
+    printf("};\n\n");
+
+    /* the units of the cells */
+    printf("static const unsigned char tables_cell_units[%d][3] = {\n",
+           size * size);
+    for (cell = 0; cell < size * size; cell++) {
+        row = cell / size;
+        col = cell % size;
+        values[0] = row;
+        values[1] = size + col;
+        values[2] = 2 * size + (row / bsize) * bsize + col / bsize;
+        tables_print_values(values, 3);
+        printf("%s\n", cell < size * size - 1 ? "," : "");
+    }
+    printf("};\n\n");
+    return;
+}
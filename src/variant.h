@@ -0,0 +1,104 @@
+/* Variant interface: Gives the external names of the grid, sudoku and dlx
+modules a suffix that depends on the block size, so that the variants of the
+library for different grid sizes can be linked in the same program */
+
+#ifndef _VARIANT_H_
+#define _VARIANT_H_
+
+/* VARIANT(name) is name_b<BSIZE>, for example grid_init_b4 for 16x16
+grids. The 9x9 variant keeps the plain names. */
+#define VARIANT_PASTE(name, bsize) name ## _b ## bsize
+#define VARIANT_EXPAND(name, bsize) VARIANT_PASTE(name, bsize)
+#if BSIZE == 3
+#define VARIANT(name) name
+#else
+#define VARIANT(name) VARIANT_EXPAND(name, BSIZE)
+#endif
+
+#if BSIZE != 3
+
+/* grid.h */
+#define grid_init VARIANT(grid_init)
+#define grid_update_value VARIANT(grid_update_value)
+#define grid_read_value_p VARIANT(grid_read_value_p)
+#define grid_read_value VARIANT(grid_read_value)
+#define grid_set_choice VARIANT(grid_set_choice)
+#define grid_clear_choice VARIANT(grid_clear_choice)
+#define grid_choice_is_valid_p VARIANT(grid_choice_is_valid_p)
+#define grid_choice_is_valid VARIANT(grid_choice_is_valid)
+#define grid_remove_choice VARIANT(grid_remove_choice)
+#define grid_read_count_p VARIANT(grid_read_count_p)
+#define grid_read_count VARIANT(grid_read_count)
+#define grid_read_choices_p VARIANT(grid_read_choices_p)
+#define grid_read_choices VARIANT(grid_read_choices)
+#define grid_write_choices VARIANT(grid_write_choices)
+#define grid_count_choices VARIANT(grid_count_choices)
+#define grid_read_used_p VARIANT(grid_read_used_p)
+#define grid_read_row_used_p VARIANT(grid_read_row_used_p)
+#define grid_set_count VARIANT(grid_set_count)
+#define grid_clear_count VARIANT(grid_clear_count)
+#define grid_count_cells_p VARIANT(grid_count_cells_p)
+#define grid_read_cell_p VARIANT(grid_read_cell_p)
+#define grid_read_cell_value_p VARIANT(grid_read_cell_value_p)
+#define grid_read_cell_choices_p VARIANT(grid_read_cell_choices_p)
+#define grid_remove_cell_choice VARIANT(grid_remove_cell_choice)
+#define grid_write_cell_choices VARIANT(grid_write_cell_choices)
+#define grid_read_unique_p VARIANT(grid_read_unique_p)
+#define grid_read_unique VARIANT(grid_read_unique)
+#define grid_set_unique VARIANT(grid_set_unique)
+#define grid_clear_unique VARIANT(grid_clear_unique)
+#define grid_reset_unique VARIANT(grid_reset_unique)
+#define grid_set_rulesok VARIANT(grid_set_rulesok)
+#define grid_clear_rulesok VARIANT(grid_clear_rulesok)
+#define grid_reset_rulesok VARIANT(grid_reset_rulesok)
+#define grid_read_rulesok_p VARIANT(grid_read_rulesok_p)
+#define grid_read_rulesok VARIANT(grid_read_rulesok)
+#define grid_rulesok_is_cached_p VARIANT(grid_rulesok_is_cached_p)
+#define grid_set_initialized VARIANT(grid_set_initialized)
+#define grid_clear_initialized VARIANT(grid_clear_initialized)
+#define grid_is_initialized_p VARIANT(grid_is_initialized_p)
+#define grid_is_initialized VARIANT(grid_is_initialized)
+
+/* sudoku.h */
+#define sudoku_read VARIANT(sudoku_read)
+#define sudoku_read_file VARIANT(sudoku_read_file)
+#define sudoku_read_lines VARIANT(sudoku_read_lines)
+#define sudoku_format_is_correct_p VARIANT(sudoku_format_is_correct_p)
+#define sudoku_format_is_correct VARIANT(sudoku_format_is_correct)
+#define sudoku_print_p VARIANT(sudoku_print_p)
+#define sudoku_print VARIANT(sudoku_print)
+#define sudoku_print_line_p VARIANT(sudoku_print_line_p)
+#define sudoku_print_errors_p VARIANT(sudoku_print_errors_p)
+#define sudoku_print_errors VARIANT(sudoku_print_errors)
+#define sudoku_print_empty_p VARIANT(sudoku_print_empty_p)
+#define sudoku_print_empty VARIANT(sudoku_print_empty)
+#define sudoku_is_correct_p VARIANT(sudoku_is_correct_p)
+#define sudoku_is_correct VARIANT(sudoku_is_correct)
+#define sudoku_solver_init VARIANT(sudoku_solver_init)
+#define sudoku_solver_seed VARIANT(sudoku_solver_seed)
+#define sudoku_solve_with_p VARIANT(sudoku_solve_with_p)
+#define sudoku_solve_bounded_p VARIANT(sudoku_solve_bounded_p)
+#define sudoku_solve_result_p VARIANT(sudoku_solve_result_p)
+#define sudoku_solve_batch VARIANT(sudoku_solve_batch)
+#define sudoku_solve_batch_results VARIANT(sudoku_solve_batch_results)
+#define sudoku_solve_p VARIANT(sudoku_solve_p)
+#define sudoku_solve VARIANT(sudoku_solve)
+#define sudoku_count_solutions_p VARIANT(sudoku_count_solutions_p)
+#define sudoku_count_solutions VARIANT(sudoku_count_solutions)
+#define sudoku_has_unique_choice_solution_p \
+    VARIANT(sudoku_has_unique_choice_solution_p)
+#define sudoku_has_unique_choice_solution \
+    VARIANT(sudoku_has_unique_choice_solution)
+#define sudoku_generate_with_p VARIANT(sudoku_generate_with_p)
+#define sudoku_generate_batch VARIANT(sudoku_generate_batch)
+#define sudoku_generate VARIANT(sudoku_generate)
+#define sudoku_insert_value VARIANT(sudoku_insert_value)
+#define sudoku_delete_value VARIANT(sudoku_delete_value)
+
+/* dlx.h */
+#define dlx_solve VARIANT(dlx_solve)
+
+#endif
+
+
+#endif